@@ -8,16 +8,38 @@
 #include <sys/shm.h>
 #include <stdio.h>
 #include <signal.h>
+#include <string.h>
 #include <unistd.h>
 #include "clk.h"
+#include "futex.h"
 
 #define SHKEY 300
+
+// Layout of the clock segment. The tick stays first so the segment still
+// reads as a plain int for get_clk().
+typedef struct
+{
+    int time;
+    // Fast-forward bookkeeping, indexed by clk_stage. stage_done holds the
+    // last finished tick + 1 so a freshly zeroed segment means "nothing yet".
+    volatile int stage_done[STAGE_COUNT];
+    volatile int stage_next[STAGE_COUNT];
+} clk_state_t;
+
 ///==============================
 // don't mess with this variable//
 int *shmaddr = NULL; //
 //===============================
 
 int shmid;
+int fast_forward = 0; // Inherited across fork, see set_fast_forward()
+
+// Publish a new tick and wake everyone blocked in wait_next_tick()
+static void publish_tick(int tick)
+{
+    __atomic_store_n(shmaddr, tick, __ATOMIC_SEQ_CST);
+    futex_wake_all(shmaddr);
+}
 
 /* Clear the resources before exit */
 void _cleanup(__attribute__((unused)) int signum)
@@ -33,8 +55,14 @@ void init_clk()
     printf("Clock starting\n");
     signal(SIGINT, _cleanup);
     int clk = 0;
-    // Create shared memory for one integer variable 4 bytes
-    shmid = shmget(SHKEY, 4, IPC_CREAT | 0644);
+    // Create shared memory for the clock state
+    shmid = shmget(SHKEY, sizeof(clk_state_t), IPC_CREAT | 0644);
+    if ((long)shmid == -1)
+    {
+        // A stale, smaller segment left by a crashed run: replace it
+        shmctl(shmget(SHKEY, 0, 0644), IPC_RMID, NULL);
+        shmid = shmget(SHKEY, sizeof(clk_state_t), IPC_CREAT | 0644);
+    }
     if ((long)shmid == -1)
     {
         perror("Error in creating shm!");
@@ -46,31 +74,74 @@ void init_clk()
         perror("Error in attaching the shm in clock!");
         exit(-1);
     }
+    memset(shmaddr, 0, sizeof(clk_state_t)); // a reused segment keeps old stage markers
     *shmaddr = clk; /* initialize shared memory */
 }
 
+// Jump from one interesting instant to the next instead of sleeping
+static void run_clk_fast_forward()
+{
+    clk_state_t *state = (clk_state_t *)shmaddr;
+    while (1)
+    {
+        int now = state->time;
+        int next = CLK_NEVER;
+        for (int stage = 0; stage < STAGE_COUNT; stage++)
+        {
+            wait_stage(stage, now);
+            if (state->stage_next[stage] < next)
+                next = state->stage_next[stage];
+        }
+
+        if (next == CLK_NEVER)
+        {
+            // Every stage retired, nothing left to simulate
+            pause();
+            continue;
+        }
+        if (next <= now)
+            next = now + 1;
+        publish_tick(next);
+    }
+}
+
 void run_clk()
 {
+    if (fast_forward)
+    {
+        run_clk_fast_forward();
+        return;
+    }
     while (1)
     {
-        usleep(100000); 
-        (*shmaddr)++;
+        usleep(100000);
+        publish_tick(*shmaddr + 1);
     }
 }
 
 int get_clk()
 {
-    return *shmaddr;
+    return __atomic_load_n(shmaddr, __ATOMIC_SEQ_CST);
+}
+
+int wait_next_tick(int tick)
+{
+    int now;
+    while ((now = get_clk()) <= tick)
+    {
+        futex_wait(shmaddr, now);
+    }
+    return now;
 }
 
 void sync_clk()
 {
-    int shmid = shmget(SHKEY, 4, 0444);
+    int shmid = shmget(SHKEY, sizeof(clk_state_t), 0444);
     while ((int)shmid == -1)
     {
         // Make sure that the clock exists
-        usleep(100000); 
-        shmid = shmget(SHKEY, 4, 0444);
+        usleep(100000);
+        shmid = shmget(SHKEY, sizeof(clk_state_t), 0444);
     }
     shmaddr = (int *)shmat(shmid, (void *)0, 0);
 }
@@ -83,3 +154,39 @@ void destroy_clk(short terminateAll)
         killpg(getpgrp(), SIGINT);
     }
 }
+
+void set_fast_forward(int enabled)
+{
+    fast_forward = enabled;
+}
+
+int is_fast_forward()
+{
+    return fast_forward;
+}
+
+void finish_stage(int stage, int tick, int next_event)
+{
+    clk_state_t *state = (clk_state_t *)shmaddr;
+    state->stage_next[stage] = next_event;
+    __atomic_store_n(&state->stage_done[stage], tick + 1, __ATOMIC_SEQ_CST);
+    futex_wake_all(&state->stage_done[stage]);
+}
+
+void wait_stage(int stage, int tick)
+{
+    clk_state_t *state = (clk_state_t *)shmaddr;
+    int done;
+    while ((done = __atomic_load_n(&state->stage_done[stage], __ATOMIC_SEQ_CST)) <= tick)
+    {
+        futex_wait(&state->stage_done[stage], done);
+    }
+}
+
+void retire_stage(int stage)
+{
+    clk_state_t *state = (clk_state_t *)shmaddr;
+    state->stage_next[stage] = CLK_NEVER;
+    __atomic_store_n(&state->stage_done[stage], CLK_NEVER, __ATOMIC_SEQ_CST);
+    futex_wake_all(&state->stage_done[stage]);
+}
@@ -1,6 +1,27 @@
 #ifndef CLK_H
 #define CLK_H
 
+#include <limits.h>
+
+/*
+ * Per-tick stages.
+ * On every tick the scheduler first reaps completions, then the generator
+ * admits arrivals, then the scheduler dispatches. Components hand the tick
+ * to each other through these markers in both modes, so a run is the same
+ * whatever the clock speed. In fast-forward mode the clock also waits for
+ * every stage and then jumps straight to the earliest next event any stage
+ * asked for.
+ */
+enum clk_stage
+{
+    STAGE_COMPLETIONS = 0, // Scheduler reaped this tick's finished processes
+    STAGE_ARRIVALS,        // Generator sent this tick's arrivals
+    STAGE_DISPATCH,        // Scheduler picked the process for this tick
+    STAGE_COUNT
+};
+
+#define CLK_NEVER INT_MAX // "No further event" for finish_stage()
+
 /*
  * This function is used to initialize the clock module.
  * It creates a shared memory segment and initializes the clock value to 0.
@@ -8,13 +29,19 @@
 void init_clk();
 /*
  * This function is used to run the clock module.
- * It increments the clock value every second.
+ * It increments the clock value every second, or in fast-forward mode jumps
+ * to the next instant some component is interested in.
  */
 void run_clk();
 /*
  *This function is used to get the clock value from the shared memory
  */
 int get_clk();
+/*
+ * Block (without spinning) until the clock moves past `tick` and return the
+ * new value. Returns at once if it already has, so no tick is ever missed.
+ */
+int wait_next_tick(int tick);
 /*
  * All process call this function at the beginning to establish communication between them and the clock module.
  * Again, remember that the clock is only emulation!
@@ -29,4 +56,25 @@ void sync_clk();
  */
 void destroy_clk(short terminateAll);
 
-#endif
\ No newline at end of file
+/*
+ * Select virtual-time mode. Must be called before the clock, the scheduler
+ * and the generator fork so every component agrees on the mode.
+ */
+void set_fast_forward(int enabled);
+int is_fast_forward();
+/*
+ * Mark `stage` as finished for `tick` and publish the earliest tick at which
+ * it has work again (CLK_NEVER if it only reacts to other stages).
+ */
+void finish_stage(int stage, int tick, int next_event);
+/*
+ * Block until `stage` has finished `tick` (or a later one).
+ */
+void wait_stage(int stage, int tick);
+/*
+ * The stage will never run again (its owner is shutting down), so nobody
+ * waits on it from now on.
+ */
+void retire_stage(int stage);
+
+#endif
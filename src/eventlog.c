@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sched.h>
+#include <pthread.h>
+#include "eventlog.h"
+#include "futex.h"
+
+#define EVENT_LOG_BUFFER (1 << 20) // Bytes collected between two writes
+#define EVENT_LINE_MAX 256         // Longest rendered line
+#define EVENT_QUEUE_RECORDS (1 << 16) // Queue bound: about 3.5 MiB per log
+#define EVENT_WRITER_NAP_NS 10000000  // Writer polls this often when not woken
+#define EVENT_CACHE_LINE 64
+
+// One queue cell. seq == position + 1 once a record is published there, and
+// position + EVENT_QUEUE_RECORDS once the writer took it.
+typedef struct
+{
+    volatile unsigned int seq;
+    event_record_t record;
+} event_cell_t;
+
+// Producers (any thread, or a signal handler that never interrupts another
+// producer of the same log) claim cells with a CAS on tail and never format
+// anything. A writer thread renders and writes them in batches. Producers
+// only block when the queue is full and only wake the writer every half
+// queue, so in the common case appending is a copy and two atomics.
+struct event_log
+{
+    int fd;
+    int binary;
+    event_cell_t *cells;
+    pthread_t writer;
+
+    volatile unsigned int tail __attribute__((aligned(EVENT_CACHE_LINE))); // Next cell to claim
+    volatile int space;        // Bumped by the writer, producers wait on it when full
+
+    unsigned int head __attribute__((aligned(EVENT_CACHE_LINE))); // Writer only
+    volatile int doorbell;     // Bumped to wake the writer early
+    volatile int closing;
+    size_t used;               // Writer only, bytes in buffer
+    char buffer[EVENT_LOG_BUFFER];
+};
+
+static const char *event_names[EVENT_TYPE_COUNT] = {
+    "started", "resumed", "stopped", "finished", "allocated", "freed"};
+
+int binary_logs = 0; // Inherited across fork, see set_binary_logs()
+
+void set_binary_logs(int enabled)
+{
+    binary_logs = enabled;
+}
+
+int binary_logs_enabled()
+{
+    return binary_logs;
+}
+
+const char *event_log_title(int kind)
+{
+    return kind == EVENT_LOG_MEMORY
+               ? "#At time x allocated y bytes for process z from i to j\n"
+               : "#At time x process y state arr w total z remain y wait k\n";
+}
+
+int event_render(const event_record_t *r, char *out, size_t size)
+{
+    if (r->type < 0 || r->type >= EVENT_TYPE_COUNT)
+        return snprintf(out, size, "Unknown event %d at time %d\n", r->type, r->time);
+
+    const char *name = event_names[r->type];
+    if (r->type == EVENT_ALLOCATED)
+        return snprintf(out, size, "At time %d %s %d bytes for process %d from %lld to %lld\n",
+                        r->time, name, r->size, r->id,
+                        (long long)r->u.memory.start, (long long)r->u.memory.end);
+    if (r->type == EVENT_FREED)
+        return snprintf(out, size, "At time %d %s %d bytes from process %d from %lld to %lld\n",
+                        r->time, name, r->size, r->id,
+                        (long long)r->u.memory.start, (long long)r->u.memory.end);
+
+    int n = snprintf(out, size, "At time %d process %d %s arr %d total %d remain %d wait %d",
+                     r->time, r->id, name, r->u.process.arrival, r->u.process.total,
+                     r->u.process.remain, r->u.process.wait);
+    if (r->type == EVENT_FINISHED)
+    {
+        if (r->u.process.has_wta)
+            n += snprintf(out + n, size - n, " TA %d WTA %.2f", r->u.process.ta, r->u.process.wta);
+        else
+            n += snprintf(out + n, size - n, " TA %d WTA Could not be calculated", r->u.process.ta);
+    }
+    if (r->cpu >= 0)
+        n += snprintf(out + n, size - n, " cpu %d", r->cpu);
+    n += snprintf(out + n, size - n, "\n");
+    return n;
+}
+
+// Write all of `data`, retrying short writes
+static void write_all(int fd, const char *data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t written = write(fd, data, length);
+        if (written == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("Error writing event log");
+            return;
+        }
+        data += written;
+        length -= written;
+    }
+}
+
+// Take the next published record, if any
+static int event_log_take(event_log_t *log, event_record_t *record)
+{
+    event_cell_t *cell = &log->cells[log->head & (EVENT_QUEUE_RECORDS - 1)];
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != log->head + 1)
+        return 0;
+    *record = cell->record;
+    __atomic_store_n(&cell->seq, log->head + EVENT_QUEUE_RECORDS, __ATOMIC_RELEASE);
+    log->head++;
+    return 1;
+}
+
+static void event_log_write_buffer(event_log_t *log)
+{
+    if (log->used == 0)
+        return;
+    write_all(log->fd, log->buffer, log->used);
+    log->used = 0;
+}
+
+static void *event_log_writer(void *arg)
+{
+    event_log_t *log = arg;
+    const struct timespec nap = {0, EVENT_WRITER_NAP_NS};
+    event_record_t record;
+    int stuck = 0;
+
+    while (1)
+    {
+        int bell = __atomic_load_n(&log->doorbell, __ATOMIC_SEQ_CST);
+        int closing = __atomic_load_n(&log->closing, __ATOMIC_SEQ_CST);
+        int taken = 0;
+        while (event_log_take(log, &record))
+        {
+            if (EVENT_LOG_BUFFER - log->used < EVENT_LINE_MAX)
+                event_log_write_buffer(log);
+            if (log->binary)
+            {
+                memcpy(log->buffer + log->used, &record, sizeof(record));
+                log->used += sizeof(record);
+            }
+            else
+            {
+                log->used += event_render(&record, log->buffer + log->used, EVENT_LINE_MAX);
+            }
+            taken++;
+        }
+        if (taken > 0)
+        {
+            __atomic_add_fetch(&log->space, 1, __ATOMIC_SEQ_CST);
+            futex_wake_all(&log->space);
+        }
+
+        if (closing)
+        {
+            // A producer interrupted between claiming and publishing (SIGINT)
+            // never finishes: give up on its cell after a while
+            if (log->head == __atomic_load_n(&log->tail, __ATOMIC_SEQ_CST) || ++stuck > 1000)
+                break;
+            sched_yield();
+            continue;
+        }
+        // Write what we have before a nap so the file never lags far behind
+        event_log_write_buffer(log);
+        futex_wait_timeout(&log->doorbell, bell, &nap);
+    }
+    event_log_write_buffer(log);
+    return NULL;
+}
+
+event_log_t *event_log_open(const char *path, int kind)
+{
+    char name[256];
+    size_t length = strlen(path);
+    if (binary_logs && length > 4 && strcmp(path + length - 4, ".log") == 0)
+        snprintf(name, sizeof(name), "%.*s.events", (int)(length - 4), path);
+    else
+        snprintf(name, sizeof(name), "%s", path);
+
+    event_log_t *log;
+    if (posix_memalign((void **)&log, EVENT_CACHE_LINE, sizeof(*log)) != 0)
+        return NULL;
+    log->fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log->fd == -1)
+    {
+        free(log);
+        return NULL;
+    }
+    log->binary = binary_logs;
+    log->used = 0;
+    log->head = log->tail = 0;
+    log->space = log->doorbell = log->closing = 0;
+    log->cells = malloc(sizeof(event_cell_t) * EVENT_QUEUE_RECORDS);
+    if (log->cells == NULL)
+    {
+        close(log->fd);
+        free(log);
+        return NULL;
+    }
+    for (unsigned int i = 0; i < EVENT_QUEUE_RECORDS; i++)
+        log->cells[i].seq = i;
+
+    if (log->binary)
+    {
+        event_log_header_t header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic));
+        header.kind = kind;
+        header.record_size = sizeof(event_record_t);
+        memcpy(log->buffer, &header, sizeof(header));
+        log->used = sizeof(header);
+    }
+    else
+    {
+        log->used = snprintf(log->buffer, EVENT_LOG_BUFFER, "%s", event_log_title(kind));
+    }
+
+    // Signals belong to the thread that opened the log, not to the writer
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    int failed = pthread_create(&log->writer, NULL, event_log_writer, log);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (failed)
+    {
+        close(log->fd);
+        free(log->cells);
+        free(log);
+        return NULL;
+    }
+    return log;
+}
+
+void event_log_append(event_log_t *log, const event_record_t *record)
+{
+    if (log == NULL)
+        return;
+
+    unsigned int position = __atomic_load_n(&log->tail, __ATOMIC_RELAXED);
+    event_cell_t *cell;
+    while (1)
+    {
+        cell = &log->cells[position & (EVENT_QUEUE_RECORDS - 1)];
+        unsigned int seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int lag = (int)(seq - position);
+        if (lag == 0)
+        {
+            if (__atomic_compare_exchange_n(&log->tail, &position, position + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (lag < 0)
+        {
+            // Full: wait for the writer to make room (backpressure)
+            int space = __atomic_load_n(&log->space, __ATOMIC_SEQ_CST);
+            __atomic_add_fetch(&log->doorbell, 1, __ATOMIC_SEQ_CST);
+            futex_wake_all(&log->doorbell);
+            if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) == seq)
+                futex_wait(&log->space, space);
+            position = __atomic_load_n(&log->tail, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            position = __atomic_load_n(&log->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->record = *record;
+    __atomic_store_n(&cell->seq, position + 1, __ATOMIC_RELEASE);
+
+    // Nudge the writer every half queue of records so a burst does not sit
+    // waiting for its next nap
+    if ((position & (EVENT_QUEUE_RECORDS / 2 - 1)) == 0 && position != 0)
+    {
+        __atomic_add_fetch(&log->doorbell, 1, __ATOMIC_SEQ_CST);
+        futex_wake_all(&log->doorbell);
+    }
+}
+
+// Write out everything appended so far and stop the writer. Also safe from
+// a SIGINT handler that interrupted an append.
+void event_log_close(event_log_t *log)
+{
+    if (log == NULL)
+        return;
+    __atomic_store_n(&log->closing, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&log->doorbell, 1, __ATOMIC_SEQ_CST);
+    futex_wake_all(&log->doorbell);
+    pthread_join(log->writer, NULL);
+    close(log->fd);
+    free(log->cells);
+    free(log);
+}
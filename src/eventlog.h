@@ -0,0 +1,96 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Event logs.
+ * scheduler.log and memory.log are streams of fixed-size event records.
+ * Appending only queues a record; a writer thread per log renders records
+ * as the usual text lines (or, in binary mode, keeps them raw for kernix-log
+ * to render into the very same text later) and writes them in batches.
+ */
+
+enum event_type
+{
+    EVENT_STARTED = 0, // scheduler.log
+    EVENT_RESUMED,
+    EVENT_STOPPED,
+    EVENT_FINISHED,
+    EVENT_ALLOCATED,   // memory.log
+    EVENT_FREED,
+    EVENT_TYPE_COUNT
+};
+
+enum event_log_kind
+{
+    EVENT_LOG_SCHEDULER = 0,
+    EVENT_LOG_MEMORY
+};
+
+typedef struct
+{
+    int32_t time;
+    int32_t id;        // Process id
+    int16_t type;      // event_type
+    int16_t cpu;       // CPU column, -1 when there is a single CPU
+    int32_t size;      // Memory events: bytes requested
+    union
+    {
+        struct
+        {
+            int32_t arrival, total, remain, wait;
+            int32_t ta;         // Finished only
+            int32_t has_wta;    // 0 for zero-runtime jobs
+            double wta;         // Already rounded to two decimals
+        } process;
+        struct
+        {
+            int64_t start, end; // Inclusive
+        } memory;
+    } u;
+} event_record_t;
+
+#define EVENT_LOG_MAGIC "KXEVLOG1"
+
+// Binary file header, followed by records up to the end of the file
+typedef struct
+{
+    char magic[8];
+    int32_t kind;          // event_log_kind
+    int32_t record_size;   // sizeof(event_record_t) of the writer
+} event_log_header_t;
+
+typedef struct event_log event_log_t;
+
+/*
+ * Select binary logs. Must be called before the scheduler forks so both
+ * writers agree.
+ */
+void set_binary_logs(int enabled);
+int binary_logs_enabled();
+
+/*
+ * Create `path` (the text name, ".events" replaces ".log" in binary mode)
+ * and start its writer thread. Returns NULL on failure. Open logs after the
+ * last fork() that is not followed by exec().
+ */
+event_log_t *event_log_open(const char *path, int kind);
+/*
+ * Queue a record. Blocks only while the bounded queue is full.
+ */
+void event_log_append(event_log_t *log, const event_record_t *record);
+/*
+ * Write out everything queued, stop the writer and free the log.
+ */
+void event_log_close(event_log_t *log);
+
+/*
+ * Text form of a record or of a log's header line, newline included.
+ * Returns the length, like snprintf.
+ */
+int event_render(const event_record_t *record, char *out, size_t size);
+const char *event_log_title(int kind);
+
+#endif
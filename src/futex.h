@@ -0,0 +1,34 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Thin wrappers over futex(2) for words living in System V shared memory.
+ * The segments are shared between processes, so the non-private ops are used.
+ */
+
+// Sleep while *addr still holds `expected`. Callers re-check their condition
+// in a loop, so spurious wake-ups and EINTR need no special handling.
+static inline void futex_wait(volatile int *addr, int expected)
+{
+    syscall(SYS_futex, addr, FUTEX_WAIT, expected, NULL, NULL, 0);
+}
+
+// Same, but give up after `timeout` (relative)
+static inline void futex_wait_timeout(volatile int *addr, int expected, const struct timespec *timeout)
+{
+    syscall(SYS_futex, addr, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+// Wake every process sleeping on addr
+static inline void futex_wake_all(volatile int *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+#endif
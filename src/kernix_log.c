@@ -0,0 +1,76 @@
+/*
+ * kernix-log: render binary event logs (os-sim -L binary) as the text the
+ * simulator writes by default.
+ *
+ *   kernix-log scheduler.events > scheduler.log
+ *   kernix-log memory.events > memory.log
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "eventlog.h"
+
+#define RECORDS_PER_READ 4096
+
+static int render_file(const char *path, FILE *out)
+{
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (in == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    event_log_header_t header;
+    if (fread(&header, sizeof(header), 1, in) != 1 ||
+        memcmp(header.magic, EVENT_LOG_MAGIC, sizeof(header.magic)) != 0)
+    {
+        fprintf(stderr, "%s: not an os-sim event log\n", path);
+        if (in != stdin)
+            fclose(in);
+        return -1;
+    }
+    if (header.record_size != (int32_t)sizeof(event_record_t))
+    {
+        fprintf(stderr, "%s: records are %d bytes, this kernix-log reads %zu\n",
+                path, header.record_size, sizeof(event_record_t));
+        if (in != stdin)
+            fclose(in);
+        return -1;
+    }
+
+    fputs(event_log_title(header.kind), out);
+
+    event_record_t *records = malloc(sizeof(event_record_t) * RECORDS_PER_READ);
+    char line[256];
+    size_t count;
+    while ((count = fread(records, sizeof(event_record_t), RECORDS_PER_READ, in)) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            event_render(&records[i], line, sizeof(line));
+            fputs(line, out);
+        }
+    }
+    free(records);
+    if (in != stdin)
+        fclose(in);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <file.events>... (- reads stdin)\n", argv[0]);
+        return 1;
+    }
+
+    int status = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (render_file(argv[i], stdout) == -1)
+            status = 1;
+    }
+    return status;
+}
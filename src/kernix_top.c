@@ -0,0 +1,116 @@
+/*
+ * kernix-top: watch a running simulation through its live metrics page.
+ *
+ *   kernix-top            refresh every 500 ms until the run ends
+ *   kernix-top -i 100     refresh every 100 ms
+ *   kernix-top -n 1       print one frame and exit
+ *
+ * The page is attached read-only and copied under its sequence locks, so
+ * watching never blocks or changes the run.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/shm.h>
+#include "statspage.h"
+
+static void show_scheduler(const stats_scheduler_section_t *s)
+{
+    printf("Scheduler   tick %d   lag %d   missed %d\n", s->time, s->tick_lag, s->ticks_missed);
+    printf("  jobs       %d ready, %d running, %d live, %lld finished\n",
+           s->ready, s->running, s->live, (long long)s->finished);
+    printf("  switches   %lld context switches, %lld preemptions\n",
+           (long long)s->context_switches, (long long)s->preemptions);
+    printf("  averages   WTA %.2f, waiting %.2f, TA %.2f\n", s->avg_wta, s->avg_waiting, s->avg_ta);
+    if (s->cpu_count > 1)
+    {
+        printf("  %5s %8s %8s\n", "CPU", "job", "ready");
+        for (int i = 0; i < s->cpu_count && i < STATS_PAGE_MAX_CPUS; i++)
+        {
+            if (s->cpu_job[i] >= 0)
+                printf("  %5d %8d %8d\n", i, s->cpu_job[i], s->cpu_ready[i]);
+            else
+                printf("  %5d %8s %8d\n", i, "idle", s->cpu_ready[i]);
+        }
+    }
+}
+
+static void show_generator(const stats_generator_section_t *g)
+{
+    printf("Generator   tick %d   lag %d\n", g->time, g->tick_lag);
+    printf("  jobs       %d of %d arrived, %d waiting for memory\n", g->arrived, g->jobs, g->waiting);
+    printf("  memory     %lld of %lld bytes free\n",
+           (long long)g->free_bytes, g->max_order > 0 ? 1LL << g->max_order : 0LL);
+    printf("  %5s %12s %12s %12s\n", "order", "block", "free blocks", "free bytes");
+    for (int order = g->min_order; order <= g->max_order && order < STATS_PAGE_MAX_ORDERS; order++)
+    {
+        printf("  %5d %12lld %12lld %12lld\n", order, 1LL << order,
+               (long long)g->free_blocks[order], (long long)g->free_blocks[order] << order);
+    }
+}
+
+// The run is over, or its generator died without saying so
+static int run_over(const stats_page_t *page)
+{
+    if (!__atomic_load_n(&page->active, __ATOMIC_ACQUIRE))
+        return 1;
+    return kill(page->generator_pid, 0) == -1 && errno == ESRCH;
+}
+
+int main(int argc, char *argv[])
+{
+    int interval_ms = 500;
+    int frames = -1; // Until the run ends
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+            interval_ms = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "Usage: %s [-i milliseconds] [-n frames]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (interval_ms <= 0)
+        interval_ms = 500;
+
+    const stats_page_t *page = stats_page_attach();
+    if (page == NULL)
+    {
+        fprintf(stderr, "No simulation is running (no stats page under key %d)\n", STATS_PAGE_KEY);
+        return 1;
+    }
+
+    int clear = isatty(STDOUT_FILENO) && frames != 1;
+    stats_scheduler_section_t scheduler;
+    stats_generator_section_t generator;
+    for (int frame = 0; frames < 0 || frame < frames; frame++)
+    {
+        int over = run_over(page);
+        if (clear)
+            printf("\033[H\033[2J");
+        printf("kernix-top   generator pid %d%s\n\n", page->generator_pid, over ? "   (run over)" : "");
+        if (stats_page_read(&page->scheduler, &scheduler, sizeof(scheduler)) == 0)
+            show_scheduler(&scheduler);
+        else
+            printf("Scheduler   (stuck mid-update)\n");
+        printf("\n");
+        if (stats_page_read(&page->generator, &generator, sizeof(generator)) == 0)
+            show_generator(&generator);
+        else
+            printf("Generator   (stuck mid-update)\n");
+        fflush(stdout);
+
+        if (over)
+            break;
+        if (frames < 0 || frame + 1 < frames)
+            usleep(interval_ms * 1000);
+    }
+    shmdt(page);
+    return 0;
+}
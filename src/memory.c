@@ -4,282 +4,342 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define TOTAL_MEMORY_SIZE 1024
-#define LOG_FILE "memory.log"
+#define MEMORY_BAR_CELLS 128
 
+// Tree node of the block with index `index` among the blocks of `order`
+#define NODE(memory, order, index) ((1 << ((memory)->maxOrder - (order))) + (int)(index))
+
+// Free set of an order
+#define FREE_LIST(memory, order) (&(memory)->freeLists[(order) - (memory)->minOrder])
 
 // Find the highest power of 2 that is less than or equal to x
 
-int highestPowerOf2(int x) {
+long highestPowerOf2(long x) {
   if (x <= 0)
     return 1;
 
-  int block_size = 1;
+  long block_size = 1;
   while (block_size < x) {
     block_size *= 2;
   }
   return block_size;
 }
 
-
- // Initialize the memory block
-memory_block_t *create_memory() {
-  memory_block_t *memory = malloc(sizeof(memory_block_t));
-  memory->size = TOTAL_MEMORY_SIZE;
-  memory->start = 0;
-  memory->end = TOTAL_MEMORY_SIZE;
-  memory->realSize = -1;
-  memory->left = NULL;
-  memory->right = NULL;
-  memory->parent = NULL;
-  memory->processId = -1;
-  memory->isFree = 1;
-  return memory;
+static int orderOf(long size) {
+  int order = 0;
+  while ((1L << order) < size)
+    order++;
+  return order;
 }
 
+// Parse a size such as "1024", "4K", "16M" or "1G" (binary units).
+// Returns -1 if the text is not a positive size.
+long parseMemorySize(const char *text) {
+  char *unit;
+  long value = strtol(text, &unit, 10);
+  if (unit == text || value <= 0)
+    return -1;
+
+  int shift = 0;
+  switch (*unit) {
+  case '\0':
+    break;
+  case 'k':
+  case 'K':
+    shift = 10;
+    break;
+  case 'm':
+  case 'M':
+    shift = 20;
+    break;
+  case 'g':
+  case 'G':
+    shift = 30;
+    break;
+  default:
+    return -1;
+  }
+  if (*unit != '\0' && unit[1] != '\0' && strcmp(unit + 1, "B") != 0 && strcmp(unit + 1, "b") != 0)
+    return -1;
+  if (value > (MAX_MEMORY_SIZE >> shift))
+    return -1;
+  return value << shift;
+}
 
-memory_block_t *initializeMemoryBlock(int size, int start, int end) {
-  memory_block_t *block = malloc(sizeof(memory_block_t));
-
-  if (block != NULL) {
-    block->size = highestPowerOf2(size);
-    block->realSize = size;
-    block->start = start;
-    block->end = end;
-    block->processId = -1;
-    block->isFree = 1;
-    block->parent = NULL;
-    block->left = NULL;
-    block->right = NULL;
+// Check the sizes and fill in defaults. Prints the problem and returns -1
+// if the configuration cannot be used.
+int validateMemoryConfig(memory_config_t *config) {
+  if (config->totalSize <= 0)
+    config->totalSize = DEFAULT_MEMORY_SIZE;
+  if (config->minBlockSize <= 0)
+    config->minBlockSize = DEFAULT_MIN_BLOCK_SIZE;
+  if (config->maxRequestSize <= 0)
+    config->maxRequestSize = config->totalSize;
+
+  if (highestPowerOf2(config->totalSize) != config->totalSize ||
+      highestPowerOf2(config->minBlockSize) != config->minBlockSize) {
+    printf("Error: memory size and minimum block size must be powers of two\n");
+    return -1;
+  }
+  if (config->minBlockSize > config->totalSize) {
+    printf("Error: minimum block size is larger than the memory\n");
+    return -1;
   }
-  return block;
+  if (orderOf(config->totalSize) - orderOf(config->minBlockSize) > MAX_TREE_DEPTH) {
+    printf("Error: memory holds more than 2^%d minimum-size blocks, use a larger -b\n", MAX_TREE_DEPTH);
+    return -1;
+  }
+  if (config->maxRequestSize > config->totalSize)
+    config->maxRequestSize = config->totalSize;
+  return 0;
 }
 
-memory_block_t *allocateMemory(memory_block_t *root, int size) {
-  // Base case: null check
-  if (root == NULL)
-    return NULL;
-    
-  // If block is already allocated, we can't use it
-  if (root->isFree == 0)
-    return NULL;
+// =============================================================================
+//                   FREE SETS
+// =============================================================================
+
+static int initFreeSet(free_set_t *set, int bits) {
+  memset(set, 0, sizeof(*set));
+  int words = (bits + 63) / 64;
+  while (set->levels < MAX_BITMAP_LEVELS) {
+    set->words[set->levels] = calloc(words, sizeof(uint64_t));
+    if (set->words[set->levels] == NULL)
+      return -1;
+    set->levels++;
+    if (words == 1)
+      break;
+    words = (words + 63) / 64;
+  }
+  return 0;
+}
 
-  // If block is too small for the requested size, we can't use it
-  int requiredSize = highestPowerOf2(size);
-  if (root->size < requiredSize)
-    return NULL;
+static int freeSetHas(free_set_t *set, int index) {
+  return (set->words[0][index >> 6] >> (index & 63)) & 1;
+}
 
-  // If this is a leaf node with exact size, we can use it
-  if (!root->left && !root->right && root->size == requiredSize) {
-    root->isFree = 0;
-    root->realSize = size; // Store the actual requested size
-    root->processId = 0; // Initialize process ID (should be set by caller)
-    return root;
+static void freeSetAdd(free_set_t *set, int index) {
+  set->count++;
+  for (int level = 0; level < set->levels; level++) {
+    uint64_t *word = &set->words[level][index >> 6];
+    int wasEmpty = (*word == 0);
+    *word |= (uint64_t)1 << (index & 63);
+    if (!wasEmpty)
+      break; // Upper levels already know this word is non-empty
+    index >>= 6;
   }
+}
 
-  // If this is a leaf node but larger than needed, split it
-  if (!root->left && !root->right && root->size > requiredSize) {
-    int halfSize = root->size / 2;
-    
-    // Create both children at once
-    root->left = initializeMemoryBlock(halfSize, root->start, root->start + halfSize);
-    if (root->left == NULL) {
-      // Handle memory allocation failure
-      return NULL;
-    }
-    root->left->parent = root;
-    
-    root->right = initializeMemoryBlock(halfSize, root->start + halfSize, root->end);
-    if (root->right == NULL) {
-      // Handle memory allocation failure - clean up left child
-      free(root->left);
-      root->left = NULL;
-      return NULL;
-    }
-    root->right->parent = root;
-    
-    // Try allocation in the left child first
-    memory_block_t *result = allocateMemory(root->left, size);
-    if (result != NULL)
-      return result;
-      
-    // If left allocation fails, try right child
-    return allocateMemory(root->right, size);
+static void freeSetRemove(free_set_t *set, int index) {
+  set->count--;
+  for (int level = 0; level < set->levels; level++) {
+    uint64_t *word = &set->words[level][index >> 6];
+    *word &= ~((uint64_t)1 << (index & 63));
+    if (*word != 0)
+      break;
+    index >>= 6;
   }
+}
 
-  int leftBest = findBestAvailableBlock(root->left, requiredSize);
-  int rightBest = findBestAvailableBlock(root->right, requiredSize);
+// Lowest index in a non-empty set
+static int freeSetFirst(free_set_t *set) {
+  int index = 0;
+  for (int level = set->levels - 1; level >= 0; level--)
+    index = (index << 6) + __builtin_ctzll(set->words[level][index]);
+  return index;
+}
 
-  if(leftBest <= rightBest) {
-    // Try to allocate in left subtree if it exists
-    if (root->left != NULL) {
-      memory_block_t *left = allocateMemory(root->left, size);
-      if (left != NULL)
-        return left;
-    }
-    // Try to allocate in right subtree if it exists
-    if (root->right != NULL) {
-      memory_block_t *right = allocateMemory(root->right, size);
-      if (right != NULL)
-      return right;
-    }   
-  }
-  else
-  {
-    // Try to allocate in right subtree if it exists
-    if (root->right != NULL) {
-      memory_block_t *right = allocateMemory(root->right, size);
-      if (right != NULL)
-      return right;
-    }   
-    if (root->left != NULL) {
-      memory_block_t *left = allocateMemory(root->left, size);
-      if (left != NULL)
-        return left;
-    }
-  }
-  // No suitable block found
-  return NULL;
+// =============================================================================
+//                   SPLIT BITMAP
+// =============================================================================
+
+static int isSplit(buddy_allocator_t *memory, int node) {
+  return (memory->split[node >> 6] >> (node & 63)) & 1;
 }
 
-int findBestAvailableBlock(memory_block_t *root, int size) {
-  // Base case: null check
-  if (root == NULL)
-    return TOTAL_MEMORY_SIZE;
+static void setSplit(buddy_allocator_t *memory, int node, int split) {
+  if (split)
+    memory->split[node >> 6] |= (uint64_t)1 << (node & 63);
+  else
+    memory->split[node >> 6] &= ~((uint64_t)1 << (node & 63));
+}
 
-  if(!root->left && !root->right && root->isFree && root->size >= size) {
-    return root->size;
+ // Initialize the memory: one free block covering everything.
+ // The configuration must have passed validateMemoryConfig().
+buddy_allocator_t *create_memory(memory_config_t *config) {
+  buddy_allocator_t *memory = calloc(1, sizeof(buddy_allocator_t));
+  if (memory == NULL)
+    return NULL;
+  memory->maxOrder = orderOf(config->totalSize);
+  memory->minOrder = orderOf(config->minBlockSize);
+  memory->maxRequestSize = config->maxRequestSize;
+
+  int nodes = 2 << (memory->maxOrder - memory->minOrder);
+  memory->split = calloc((nodes + 63) / 64, sizeof(uint64_t));
+  memory->freeLists = calloc(memory->maxOrder - memory->minOrder + 1, sizeof(free_set_t));
+  memory->allocated = createHashMap(64);
+  memory->blocks = createSlab(sizeof(memory_block_t), 64);
+  if (!memory->split || !memory->freeLists || !memory->allocated || !memory->blocks) {
+    perror("Error allocating the buddy allocator");
+    exit(1);
   }
-  // Check left and right children
-  int leftSize = findBestAvailableBlock(root->left, size);
-  int rightSize = findBestAvailableBlock(root->right, size);
-  // Return the smaller size
-  if (leftSize < rightSize) {
-    return leftSize;
-  } else {
-    return rightSize;
+  for (int order = memory->minOrder; order <= memory->maxOrder; order++) {
+    if (initFreeSet(FREE_LIST(memory, order), 1 << (memory->maxOrder - order)) == -1) {
+      perror("Error allocating the buddy free lists");
+      exit(1);
+    }
   }
+
+  freeSetAdd(FREE_LIST(memory, memory->maxOrder), 0);
+  return memory;
 }
 
-void deallocate_memory(memory_block_t *root, pid_t processId) {
-  // Base case: null check
-  if (root == NULL)
-    return;
-  
-  // Check if this is the block we want to free
-  if (root->processId == processId) {
-      // Mark the block as free
-      root->isFree = 1;
-      root->processId = -1;
-      
-      // Handle merging of free blocks - we need to go up the tree
-      memory_block_t *current = root;
-      memory_block_t *parent = root->parent;
-      
-      // If it has a parent, try to merge siblings
-      while (parent != NULL) {
-          // Check if sibling exists and is free
-          memory_block_t *sibling = (parent->left == current) ? parent->right : parent->left;
-          
-          // If both children are free and are leaf nodes, merge them
-          if (sibling != NULL && sibling->isFree && current->isFree && 
-              !current->left && !current->right && !sibling->left && !sibling->right) {
-              
-              // Free the memory for the children
-              free(parent->left);
-              free(parent->right);
-              parent->left = NULL;
-              parent->right = NULL;
-              parent->isFree = 1;
-              
-              // Continue up the tree
-              current = parent;
-              parent = parent->parent;
-          } else {
-              // Can't merge further
-              break;
-          }
-      }
-      return;
+// Free the block and merge it with its buddy for as long as the buddy is free
+static void releaseBlock(buddy_allocator_t *memory, int order, int index) {
+  while (order < memory->maxOrder && freeSetHas(FREE_LIST(memory, order), index ^ 1)) {
+    freeSetRemove(FREE_LIST(memory, order), index ^ 1);
+    order++;
+    index >>= 1;
+    setSplit(memory, NODE(memory, order, index), 0);
   }
-  
-  // If not found, search in children
-  if (root->left != NULL)
-    deallocate_memory(root->left, processId);
-  
-  if (root->right != NULL)
-    deallocate_memory(root->right, processId);
+  freeSetAdd(FREE_LIST(memory, order), index);
 }
 
+// Order of the block a request of `size` bytes gets
+int memoryOrderFor(buddy_allocator_t *memory, int size) {
+  int order = orderOf(highestPowerOf2(size));
+  return order < memory->minOrder ? memory->minOrder : order;
+}
 
-// findMemoryBlock - Find a memory block by address used by printing
-memory_block_t *findMemoryBlock(memory_block_t *root, int addr) {
-  if (root == NULL)
-    return NULL;
+// Largest order with a free block, -1 when the memory is full. A request
+// fits iff its order is at most this.
+int largestFreeOrder(buddy_allocator_t *memory) {
+  for (int order = memory->maxOrder; order >= memory->minOrder; order--) {
+    if (FREE_LIST(memory, order)->count > 0)
+      return order;
+  }
+  return -1;
+}
 
-  if (!root->left && !root->right && addr >= root->start && addr < root->end)
-    return root;
+// Best fit: take the lowest free block of the smallest order that fits and
+// split it down, keeping the lower half each time
+memory_handle_t allocateMemory(buddy_allocator_t *memory, int size) {
+  memory_handle_t handle = {-1, -1};
+  if (memory == NULL || size > memory->maxRequestSize)
+    return handle;
+
+  int requiredOrder = memoryOrderFor(memory, size);
+
+  int order = requiredOrder;
+  while (order <= memory->maxOrder && FREE_LIST(memory, order)->count == 0)
+    order++;
+  if (order > memory->maxOrder)
+    return handle;
+
+  memory_block_t *block = slabAlloc(memory->blocks);
+  if (block == NULL)
+    return handle;
+
+  int index = freeSetFirst(FREE_LIST(memory, order));
+  freeSetRemove(FREE_LIST(memory, order), index);
+  while (order > requiredOrder) {
+    setSplit(memory, NODE(memory, order, index), 1);
+    order--;
+    index *= 2;
+    freeSetAdd(FREE_LIST(memory, order), index + 1); // The upper buddy
+  }
 
-  memory_block_t *left = findMemoryBlock(root->left, addr);
-  if (left != NULL)
-    return left;
+  block->order = order;
+  block->size = 1L << order;
+  block->start = (long)index << order;
+  block->end = block->start + block->size;
+  block->processId = 0;   // Set by setMemoryOwner()
+  hashMapPut(memory->allocated, NODE(memory, order, index), block);
 
-  return findMemoryBlock(root->right, addr);
+  handle.start = block->start;
+  handle.order = order;
+  return handle;
 }
 
-// findMemoryBlockByProcessId - Find a memory block by process ID
-memory_block_t *findMemoryBlockByProcessId(memory_block_t *root, pid_t processId) {
-  if (root == NULL)
+// O(1): the handle names the tree node directly
+memory_block_t *getMemoryBlock(buddy_allocator_t *memory, memory_handle_t handle) {
+  if (memory == NULL || !MEMORY_HANDLE_VALID(handle))
     return NULL;
+  return hashMapGet(memory->allocated, NODE(memory, handle.order, handle.start >> handle.order));
+}
 
-  if (root->processId == processId)
-    return root;
+void setMemoryOwner(buddy_allocator_t *memory, memory_handle_t handle, pid_t processId) {
+  memory_block_t *block = getMemoryBlock(memory, handle);
+  if (block == NULL)
+    return;
+  block->processId = processId;
+}
 
-  memory_block_t *left = findMemoryBlockByProcessId(root->left, processId);
-  if (left != NULL)
-    return left;
+void freeMemory(buddy_allocator_t *memory, memory_handle_t handle) {
+  memory_block_t *block = getMemoryBlock(memory, handle);
+  if (block == NULL)
+    return;
 
-  return findMemoryBlockByProcessId(root->right, processId);
+  hashMapRemove(memory->allocated, NODE(memory, handle.order, handle.start >> handle.order));
+  releaseBlock(memory, handle.order, (int)(handle.start >> handle.order));
+  slabFree(memory->blocks, block);
 }
 
+// findMemoryBlock - Find the allocated block covering an address, used by printing
+memory_block_t *findMemoryBlock(buddy_allocator_t *memory, long addr) {
+  if (memory == NULL || addr < 0 || addr >= (1L << memory->maxOrder))
+    return NULL;
 
-void createMemoryLogFile() {
-  FILE *logFileptr = fopen(LOG_FILE, "w");
-  if (logFileptr == NULL) {
-    perror("Can't Create Log File");
-    exit(-1);
+  int order = memory->maxOrder;
+  int index = 0;
+  while (order > memory->minOrder && isSplit(memory, NODE(memory, order, index))) {
+    order--;
+    index = (int)(addr >> order);
   }
-
-  printf("Started Logging\n");
-  fclose(logFileptr);
+  return hashMapGet(memory->allocated, NODE(memory, order, index));
 }
 
-void fancyPrintTree(memory_block_t *root, int level) {
-  if (root == NULL)
-    return;
+static void fancyPrintNode(buddy_allocator_t *memory, int order, int index, int level) {
+  int node = NODE(memory, order, index);
+  memory_block_t *block = hashMapGet(memory->allocated, node);
+  long start = (long)index << order;
 
-  printf("%s", root->isFree ? ANSI_GREEN : ANSI_RED);
+  printf("%s", block == NULL ? ANSI_GREEN : ANSI_RED);
 
   for (int i = 0; i < level; i++)
     printf("|  ");
 
-  printf("[%d-%d] %s - Process ID: %d\n", root->start, root->end,
-         root->isFree ? "Free" : "Allocated", root->processId);
+  printf("[%ld-%ld] %s - Process ID: %d\n", start, start + (1L << order),
+         block == NULL ? "Free" : "Allocated", block == NULL ? -1 : block->processId);
 
   printf(ANSI_RESET);
 
-  fancyPrintTree(root->left, level + 1);
-  fancyPrintTree(root->right, level + 1);
+  if (order > memory->minOrder && isSplit(memory, node)) {
+    fancyPrintNode(memory, order - 1, index * 2, level + 1);
+    fancyPrintNode(memory, order - 1, index * 2 + 1, level + 1);
+  }
 }
 
-void fancyPrintMemoryBar(memory_block_t *root) {
-  if (root == NULL)
+void fancyPrintTree(buddy_allocator_t *memory, int level) {
+  if (memory == NULL)
     return;
 
+  fancyPrintNode(memory, memory->maxOrder, 0, level);
+}
+
+void fancyPrintMemoryBar(buddy_allocator_t *memory) {
+  if (memory == NULL)
+    return;
+
+  // One cell per 1/128th of the memory, at least one minimum block wide
+  long total = 1L << memory->maxOrder;
+  long step = total / MEMORY_BAR_CELLS;
+  if (step < (1L << memory->minOrder))
+    step = 1L << memory->minOrder;
+
   printf(ANSI_BLACK);
-  for (int addr = 0; addr < 1024; addr += 8) {
-    memory_block_t *block = findMemoryBlock(root, addr);
-    if (block != NULL && !block->isFree) {
+  for (long addr = 0; addr < total; addr += step) {
+    memory_block_t *block = findMemoryBlock(memory, addr);
+    if (block != NULL) {
       switch (block->processId % 6) {
       case 0:
         printf(ANSI_RED_BG);
@@ -311,4 +371,3 @@ void fancyPrintMemoryBar(memory_block_t *root) {
   printf(ANSI_RESET);
   printf("\n");
 }
-
@@ -1,38 +1,93 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <sys/types.h>
+#include "models/HashMap/hashMap.h"
+#include "models/Slab/slab.h"
 /**
  * memory_block_t
- * A struct to represent a memory block in the memory
+ * A struct to represent an allocated block in the memory
  */
 typedef struct memory_block {
-    int size;
-    int realSize;
-    int start;
-    int end;
+    long size;
+    long start;
+    long end;
     pid_t processId;
-    int isFree;
-  
-    // tree like pointers
-    struct memory_block *parent;
-    struct memory_block *left;
-    struct memory_block *right;
+    int order;      // log2(size)
   } memory_block_t;
-  
+
+/**
+ * memory_handle_t
+ * Names an allocated block by its start and order, so it can be freed
+ * without searching. A failed allocation has start == -1.
+ */
+typedef struct memory_handle {
+    long start;
+    int order;
+  } memory_handle_t;
+
+#define MEMORY_HANDLE_VALID(handle) ((handle).start >= 0)
+#define MEMORY_HANDLE_END(handle) ((handle).start + (1L << (handle).order))
+
+#define MAX_BITMAP_LEVELS 8
+
+/**
+ * free_set_t
+ * The free blocks of one order, kept as a bitmap with summary levels on top
+ * so the lowest free address is found in O(log64 n).
+ */
+typedef struct free_set {
+    uint64_t *words[MAX_BITMAP_LEVELS]; // words[0] has one bit per block
+    int levels;
+    int count;
+  } free_set_t;
+
+#define DEFAULT_MEMORY_SIZE 1024
+#define DEFAULT_MIN_BLOCK_SIZE 1
+#define MAX_TREE_DEPTH 26 // At most 2^26 minimum-size blocks
+#define MAX_MEMORY_SIZE (1L << 62) // Largest size parseMemorySize() accepts
+
+/**
+ * memory_config_t
+ * Sizes in bytes. totalSize and minBlockSize must be powers of two.
+ */
+typedef struct memory_config {
+    long totalSize;
+    long minBlockSize;
+    long maxRequestSize; // 0 means totalSize
+  } memory_config_t;
+
+/**
+ * buddy_allocator_t
+ * Buddy system over [0, 2^maxOrder). Blocks are addressed implicitly as nodes
+ * of a complete binary tree (root = 1, children of n are 2n and 2n+1), so a
+ * buddy is found by flipping the lowest bit of its index.
+ */
+typedef struct buddy_allocator {
+    int maxOrder;                       // log2(total size)
+    int minOrder;                       // log2(smallest block)
+    long maxRequestSize;                // Larger requests are refused
+    uint64_t *split;                    // One bit per tree node: node is split
+    free_set_t *freeLists;              // Indexed by order - minOrder
+    HashMap *allocated;                 // Tree node -> memory_block_t
+    Slab *blocks;                       // Storage for the descriptors above
+  } buddy_allocator_t;
+
   // =============================================================================
   // INTERNAL FUNCTIONS
-  int highestPowerOf2(int x);
-  memory_block_t *initializeMemoryBlock(int size, int start, int end);
-  memory_block_t *findMemoryBlock(memory_block_t *root, int addr);
-  memory_block_t *findMemoryBlockByProcessId(memory_block_t *root, pid_t processId);
-  
+  long highestPowerOf2(long x);
+  memory_block_t *findMemoryBlock(buddy_allocator_t *memory, long addr);
+
   // API
-  memory_block_t *create_memory();
-  memory_block_t *allocateMemory(memory_block_t *root, int size);
-  void deallocate_memory(memory_block_t *root, pid_t processId);
-  
-  // output functions
-  void createMemoryLogFile();
+  long parseMemorySize(const char *text);
+  int validateMemoryConfig(memory_config_t *config);
+  buddy_allocator_t *create_memory(memory_config_t *config);
+  int memoryOrderFor(buddy_allocator_t *memory, int size);
+  int largestFreeOrder(buddy_allocator_t *memory);
+  memory_handle_t allocateMemory(buddy_allocator_t *memory, int size);
+  memory_block_t *getMemoryBlock(buddy_allocator_t *memory, memory_handle_t handle);
+  void setMemoryOwner(buddy_allocator_t *memory, memory_handle_t handle, pid_t processId);
+  void freeMemory(buddy_allocator_t *memory, memory_handle_t handle);
 
 
   // =============================================================================
@@ -0,0 +1,149 @@
+#include <stdint.h>
+#include "hashMap.h"
+
+// Fibonacci hashing: the top bits of the product depend on every bit of
+// the key, so sequential and strided pids/ids spread over the whole table
+static int slotFor(HashMap *map, int key)
+{
+    return (int)(((uint32_t)key * 2654435769u) >> map->shift);
+}
+
+// Find the slot holding key, or the empty slot where it would go
+static int findSlot(HashMap *map, int key)
+{
+    int i = slotFor(map, key);
+    while (map->values[i] != NULL && map->keys[i] != key)
+    {
+        i = (i + 1) & (map->capacity - 1);
+    }
+    return i;
+}
+
+// Allocate empty key/value arrays of the given capacity
+static bool allocateSlots(HashMap *map, int capacity)
+{
+    map->keys = malloc(sizeof(int) * capacity);
+    map->values = calloc(capacity, sizeof(void *));
+    if (map->keys == NULL || map->values == NULL)
+    {
+        free(map->keys);
+        free(map->values);
+        return false;
+    }
+    map->capacity = capacity;
+    map->shift = 32 - __builtin_ctz(capacity);
+    return true;
+}
+
+// Double the table and re-insert every entry
+static bool grow(HashMap *map)
+{
+    int *oldKeys = map->keys;
+    void **oldValues = map->values;
+    int oldCapacity = map->capacity;
+
+    if (!allocateSlots(map, oldCapacity * 2))
+    {
+        map->keys = oldKeys;
+        map->values = oldValues;
+        return false;
+    }
+    for (int i = 0; i < oldCapacity; i++)
+    {
+        if (oldValues[i] != NULL)
+        {
+            int slot = findSlot(map, oldKeys[i]);
+            map->keys[slot] = oldKeys[i];
+            map->values[slot] = oldValues[i];
+        }
+    }
+    free(oldKeys);
+    free(oldValues);
+    return true;
+}
+
+// Create a map that holds `capacity` entries before it first grows
+HashMap *createHashMap(int capacity)
+{
+    HashMap *map = malloc(sizeof(*map));
+    if (map == NULL)
+        return NULL;
+
+    int slots = 16;
+    while (slots < capacity * 2) // Keep the load factor at or below 1/2
+        slots *= 2;
+
+    map->size = 0;
+    if (!allocateSlots(map, slots))
+    {
+        printf("Error in allocating memory for hash map\n");
+        free(map);
+        return NULL;
+    }
+    return map;
+}
+
+// Insert or replace the value for key. Values must not be NULL.
+bool hashMapPut(HashMap *map, int key, void *value)
+{
+    if ((map->size + 1) * 4 > map->capacity * 3 && !grow(map))
+    {
+        printf("Hash map is full\n");
+        return false;
+    }
+
+    int slot = findSlot(map, key);
+    if (map->values[slot] == NULL)
+        map->size++;
+    map->keys[slot] = key;
+    map->values[slot] = value;
+    return true;
+}
+
+// Get the value stored for key, or NULL
+void *hashMapGet(HashMap *map, int key)
+{
+    return map->values[findSlot(map, key)];
+}
+
+// Remove key and return its value (NULL if absent)
+void *hashMapRemove(HashMap *map, int key)
+{
+    int mask = map->capacity - 1;
+    int hole = findSlot(map, key);
+    void *value = map->values[hole];
+    if (value == NULL)
+        return NULL;
+
+    // Backward-shift: pull later entries of the probe run into the hole so
+    // every remaining key stays reachable from its home slot
+    int i = hole;
+    while (1)
+    {
+        i = (i + 1) & mask;
+        if (map->values[i] == NULL)
+            break;
+        int home = slotFor(map, map->keys[i]);
+        // Move the entry unless its home lies cyclically in (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            map->keys[hole] = map->keys[i];
+            map->values[hole] = map->values[i];
+            hole = i;
+        }
+    }
+    map->values[hole] = NULL;
+    map->size--;
+    return value;
+}
+
+// Destroy the map (the stored values are not freed)
+void destroyHashMap(HashMap *map)
+{
+    if (map == NULL)
+        return;
+
+    free(map->keys);
+    free(map->values);
+    free(map);
+}
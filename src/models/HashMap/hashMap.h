@@ -0,0 +1,22 @@
+#pragma once
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+
+// Open-addressing hash map from int keys (pids, process ids) to pointers.
+// Linear probing with backward-shift deletion, so there are no tombstones
+// and lookups never degrade after many removals.
+typedef struct HashMap
+{
+    int *keys;
+    void **values;     // NULL marks an empty slot
+    int capacity;      // Always a power of two, at least 16
+    int shift;         // 32 - log2(capacity): hashes keep their top bits
+    int size;
+} HashMap;
+
+HashMap *createHashMap(int capacity);
+bool hashMapPut(HashMap *map, int key, void *value);
+void *hashMapGet(HashMap *map, int key);
+void *hashMapRemove(HashMap *map, int key);
+void destroyHashMap(HashMap *map);
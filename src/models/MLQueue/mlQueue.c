@@ -0,0 +1,77 @@
+#include "mlQueue.h"
+
+// Create a queue with levelCount (1..ML_QUEUE_MAX_LEVELS) empty levels
+MLQueue *createMLQueue(int levelCount)
+{
+    if (levelCount < 1 || levelCount > ML_QUEUE_MAX_LEVELS)
+        return NULL;
+
+    MLQueue *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL)
+        return NULL;
+    queue->levelCount = levelCount;
+    for (int i = 0; i < levelCount; i++)
+    {
+        queue->levels[i] = createQueue();
+        if (queue->levels[i] == NULL)
+        {
+            printf("Error in allocating memory for multi-level queue\n");
+            destroyMLQueue(queue);
+            return NULL;
+        }
+    }
+    return queue;
+}
+
+// Append data at the tail of a level
+void mlQueuePush(MLQueue *queue, int level, void *data)
+{
+    enqueue(queue->levels[level], data);
+    queue->nonEmpty |= (uint32_t)1 << level;
+    queue->size++;
+}
+
+// Highest (lowest-numbered) level holding anything, -1 if empty
+int mlQueueHighestLevel(MLQueue *queue)
+{
+    return queue->nonEmpty ? __builtin_ctz(queue->nonEmpty) : -1;
+}
+
+// Remove the head of a level, NULL if that level is empty
+void *mlQueuePopLevel(MLQueue *queue, int level)
+{
+    Queue *fifo = queue->levels[level];
+    if (isEmpty(fifo))
+        return NULL;
+
+    void *data = dequeue(fifo);
+    if (isEmpty(fifo))
+        queue->nonEmpty &= ~((uint32_t)1 << level);
+    queue->size--;
+    return data;
+}
+
+// Remove the head of the highest non-empty level and report that level
+void *mlQueuePop(MLQueue *queue, int *level)
+{
+    int highest = mlQueueHighestLevel(queue);
+    if (level)
+        *level = highest;
+    return highest < 0 ? NULL : mlQueuePopLevel(queue, highest);
+}
+
+// Number of items; takes void * to match getSize() on a Queue
+int mlQueueSize(void *queue)
+{
+    return queue == NULL ? 0 : ((MLQueue *)queue)->size;
+}
+
+void destroyMLQueue(MLQueue *queue)
+{
+    if (queue == NULL)
+        return;
+
+    for (int i = 0; i < queue->levelCount; i++)
+        destroyQueue(queue->levels[i]);
+    free(queue);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "models/Queue/queue.h"
+
+#define ML_QUEUE_MAX_LEVELS 32
+
+// A FIFO per priority level (0 is the highest) plus a bitmap of the levels
+// that hold anything, so push, pop and "highest non-empty level" are O(1).
+typedef struct MLQueue
+{
+    Queue *levels[ML_QUEUE_MAX_LEVELS];
+    int levelCount;
+    uint32_t nonEmpty;  // Bit i set iff levels[i] is not empty
+    int size;           // Items over all levels
+} MLQueue;
+
+MLQueue *createMLQueue(int levelCount);
+void mlQueuePush(MLQueue *queue, int level, void *data);
+void *mlQueuePop(MLQueue *queue, int *level);
+int mlQueueHighestLevel(MLQueue *queue);
+void *mlQueuePopLevel(MLQueue *queue, int level);
+int mlQueueSize(void *queue);
+void destroyMLQueue(MLQueue *queue);
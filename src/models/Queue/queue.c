@@ -1,21 +1,23 @@
 #include "queue.h"
 
+#define INITIAL_QUEUE_CAPACITY 16
+
 typedef struct {
   int pid;
   int priority;
 } process;
 
-Node* createNode(void* data) {
-  Node* newnode = (Node*)malloc(sizeof(Node));
-  newnode->data = data;
-  newnode->next = NULL;
-  return newnode;
-}
-
 Queue* createQueue() {
   Queue* queue = (Queue*)malloc(sizeof(Queue));
-  queue->front = NULL;
-  queue->rear = NULL;
+  if (queue == NULL)
+    return NULL;
+  queue->items = (void**)malloc(sizeof(void*) * INITIAL_QUEUE_CAPACITY);
+  if (queue->items == NULL) {
+    free(queue);
+    return NULL;
+  }
+  queue->capacity = INITIAL_QUEUE_CAPACITY;
+  queue->front = 0;
   queue->size = 0;
   return queue;
 }
@@ -27,15 +29,14 @@ int isEmpty(void* queue) {
   return q->size == 0;
 }
 
-int getSize(Queue* queue) {
-  return queue->size;
+int getSize(void* queue) {
+  Queue* q = (Queue*)queue;
+  return q == NULL ? 0 : q->size;
 }
 
 void printQueue(Queue* queue, void (*printFunc)(void *)) {
-  Node* curr = queue->front;
-  while (curr != NULL) {
-      printFunc(curr->data);
-      curr = curr->next;
+  for (int i = 0; i < queue->size; i++) {
+      printFunc(queue->items[(queue->front + i) & (queue->capacity - 1)]);
   }
   printf("\n");
 }
@@ -45,20 +46,28 @@ void printProcess(void* data) {
   printf("Process ID: %d, Priority: %d /", p->pid, p->priority);
 }
 
+// Double the array, unwrapping the items so the oldest is at slot 0
+static int growQueue(Queue* queue) {
+  int capacity = queue->capacity * 2;
+  void** items = (void**)malloc(sizeof(void*) * capacity);
+  if (items == NULL)
+    return 0;
+  for (int i = 0; i < queue->size; i++) {
+    items[i] = queue->items[(queue->front + i) & (queue->capacity - 1)];
+  }
+  free(queue->items);
+  queue->items = items;
+  queue->capacity = capacity;
+  queue->front = 0;
+  return 1;
+}
 
 void enqueue(Queue* queue, void* data) {
-  Node* newnode = createNode(data);
-  if (newnode == NULL) {
+  if (queue->size == queue->capacity && !growQueue(queue)) {
     printf("Memory allocation failed\n");
     return;
   }
-  if(isEmpty(queue)) {
-    queue->front = queue->rear = newnode;
-  }
-  else {
-    queue->rear->next = newnode;
-    queue->rear = newnode;
-  }
+  queue->items[(queue->front + queue->size) & (queue->capacity - 1)] = data;
   queue->size++;
 }
 
@@ -67,14 +76,16 @@ void* dequeue(Queue* queue) {
     printf("Queue is empty\n");
     return NULL;
   }
-  
-  Node* temp = queue->front;
-  void* data = temp->data;
-  queue->front = queue->front->next;
-  if(queue->front == NULL) {
-    queue->rear = NULL;
-  }
-  free(temp);
+
+  void* data = queue->items[queue->front];
+  queue->front = (queue->front + 1) & (queue->capacity - 1);
   queue->size--;
   return data;
 }
+
+void destroyQueue(Queue* queue) {
+  if (queue == NULL)
+    return;
+  free(queue->items);
+  free(queue);
+}
@@ -3,22 +3,19 @@
 #include <stdbool.h>
 #include "stdio.h"
 
-typedef struct Node {
-  void* data;
-  struct Node* next;
-} Node;
-
-
+// FIFO of pointers in a growable circular array. Enqueue/dequeue never
+// allocate once the array is big enough, and the size is always known.
 typedef struct Queue {
-  Node* front;
-  Node* rear;
+  void** items;
+  int capacity;   // Always a power of two
+  int front;      // Slot of the oldest item
   int size;
 } Queue;
 
-Node* createNode(void* data);
 Queue* createQueue();
 int isEmpty(void *queue);
-int getSize(Queue* queue);
+int getSize(void *queue);
 void printQueue(Queue* queue, void (*printFunc)(void *));
 void enqueue(Queue* queue, void* data);
-void* dequeue(Queue* queue);
\ No newline at end of file
+void* dequeue(Queue* queue);
+void destroyQueue(Queue* queue);
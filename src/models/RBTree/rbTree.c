@@ -0,0 +1,334 @@
+#include <string.h>
+#include "rbTree.h"
+
+#define NODE(t, i) ((t)->nodes[i])
+#define IS_RED(t, i) ((i) != RB_NIL && NODE(t, i).red)
+
+// Strict "a comes before b"
+static bool nodeLess(RBTree *tree, int a, int b)
+{
+    return NODE(tree, a).key < NODE(tree, b).key ||
+           (NODE(tree, a).key == NODE(tree, b).key && NODE(tree, a).tie < NODE(tree, b).tie);
+}
+
+// Make room for node `index`
+static bool reserveNode(RBTree *tree, int index)
+{
+    if (index < tree->capacity)
+        return true;
+
+    int capacity = tree->capacity > 0 ? tree->capacity : 16;
+    while (capacity <= index)
+        capacity *= 2;
+    RBNode *nodes = realloc(tree->nodes, sizeof(RBNode) * capacity);
+    if (nodes == NULL)
+        return false;
+    memset(nodes + tree->capacity, 0, sizeof(RBNode) * (capacity - tree->capacity));
+    tree->nodes = nodes;
+    tree->capacity = capacity;
+    return true;
+}
+
+// Put v where u was under u's parent
+static void replaceChild(RBTree *tree, int u, int v)
+{
+    int parent = NODE(tree, u).parent;
+    if (parent == RB_NIL)
+        tree->root = v;
+    else if (NODE(tree, parent).left == u)
+        NODE(tree, parent).left = v;
+    else
+        NODE(tree, parent).right = v;
+    if (v != RB_NIL)
+        NODE(tree, v).parent = parent;
+}
+
+static void rotateLeft(RBTree *tree, int x)
+{
+    int y = NODE(tree, x).right;
+    NODE(tree, x).right = NODE(tree, y).left;
+    if (NODE(tree, y).left != RB_NIL)
+        NODE(tree, NODE(tree, y).left).parent = x;
+    replaceChild(tree, x, y);
+    NODE(tree, y).left = x;
+    NODE(tree, x).parent = y;
+}
+
+static void rotateRight(RBTree *tree, int x)
+{
+    int y = NODE(tree, x).left;
+    NODE(tree, x).left = NODE(tree, y).right;
+    if (NODE(tree, y).right != RB_NIL)
+        NODE(tree, NODE(tree, y).right).parent = x;
+    replaceChild(tree, x, y);
+    NODE(tree, y).right = x;
+    NODE(tree, x).parent = y;
+}
+
+static int minimum(RBTree *tree, int node)
+{
+    while (NODE(tree, node).left != RB_NIL)
+        node = NODE(tree, node).left;
+    return node;
+}
+
+// Create a tree with room for indices below `capacity`
+RBTree *createRBTree(int capacity)
+{
+    RBTree *tree = calloc(1, sizeof(*tree));
+    if (tree == NULL)
+        return NULL;
+    tree->root = RB_NIL;
+    tree->first = RB_NIL;
+    if (!reserveNode(tree, capacity > 0 ? capacity - 1 : 0))
+    {
+        printf("Error in allocating memory for red-black tree\n");
+        free(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+// Insert `index` with the given order. Fails if it is already in the tree.
+bool rbTreeInsert(RBTree *tree, int64_t key, int tie, int index)
+{
+    if (index < 0 || !reserveNode(tree, index) || NODE(tree, index).linked)
+        return false;
+
+    RBNode *z = &NODE(tree, index);
+    z->key = key;
+    z->tie = tie;
+    z->left = z->right = RB_NIL;
+    z->red = 1;
+    z->linked = 1;
+
+    // Ordinary BST descent, noting whether we only ever went left
+    int parent = RB_NIL;
+    int node = tree->root;
+    bool leftmost = true;
+    while (node != RB_NIL)
+    {
+        parent = node;
+        if (nodeLess(tree, index, node))
+            node = NODE(tree, node).left;
+        else
+        {
+            node = NODE(tree, node).right;
+            leftmost = false;
+        }
+    }
+    z->parent = parent;
+    if (parent == RB_NIL)
+        tree->root = index;
+    else if (nodeLess(tree, index, parent))
+        NODE(tree, parent).left = index;
+    else
+        NODE(tree, parent).right = index;
+    if (leftmost)
+        tree->first = index;
+    tree->size++;
+
+    // Restore the red-black properties
+    int x = index;
+    while (IS_RED(tree, NODE(tree, x).parent))
+    {
+        int p = NODE(tree, x).parent;
+        int g = NODE(tree, p).parent;
+        if (p == NODE(tree, g).left)
+        {
+            int uncle = NODE(tree, g).right;
+            if (IS_RED(tree, uncle))
+            {
+                NODE(tree, p).red = NODE(tree, uncle).red = 0;
+                NODE(tree, g).red = 1;
+                x = g;
+                continue;
+            }
+            if (x == NODE(tree, p).right)
+            {
+                x = p;
+                rotateLeft(tree, x);
+                p = NODE(tree, x).parent;
+            }
+            NODE(tree, p).red = 0;
+            NODE(tree, g).red = 1;
+            rotateRight(tree, g);
+        }
+        else
+        {
+            int uncle = NODE(tree, g).left;
+            if (IS_RED(tree, uncle))
+            {
+                NODE(tree, p).red = NODE(tree, uncle).red = 0;
+                NODE(tree, g).red = 1;
+                x = g;
+                continue;
+            }
+            if (x == NODE(tree, p).left)
+            {
+                x = p;
+                rotateRight(tree, x);
+                p = NODE(tree, x).parent;
+            }
+            NODE(tree, p).red = 0;
+            NODE(tree, g).red = 1;
+            rotateLeft(tree, g);
+        }
+    }
+    NODE(tree, tree->root).red = 0;
+    return true;
+}
+
+// Smallest element, RB_NIL if empty
+int rbTreeFirst(RBTree *tree)
+{
+    return tree->first;
+}
+
+// Remove `index`. Returns false if it is not in the tree.
+bool rbTreeRemove(RBTree *tree, int index)
+{
+    if (!rbTreeContains(tree, index))
+        return false;
+
+    int z = index;
+    if (tree->first == z) // The leftmost node has no left child
+        tree->first = NODE(tree, z).right != RB_NIL ? minimum(tree, NODE(tree, z).right) : NODE(tree, z).parent;
+
+    // x moves into the removed position; track its parent since x may be nil
+    int x, xParent;
+    bool removedBlack = !NODE(tree, z).red;
+    if (NODE(tree, z).left == RB_NIL)
+    {
+        x = NODE(tree, z).right;
+        xParent = NODE(tree, z).parent;
+        replaceChild(tree, z, x);
+    }
+    else if (NODE(tree, z).right == RB_NIL)
+    {
+        x = NODE(tree, z).left;
+        xParent = NODE(tree, z).parent;
+        replaceChild(tree, z, x);
+    }
+    else
+    {
+        int y = minimum(tree, NODE(tree, z).right);
+        removedBlack = !NODE(tree, y).red;
+        x = NODE(tree, y).right;
+        if (NODE(tree, y).parent == z)
+            xParent = y;
+        else
+        {
+            xParent = NODE(tree, y).parent;
+            replaceChild(tree, y, x);
+            NODE(tree, y).right = NODE(tree, z).right;
+            NODE(tree, NODE(tree, y).right).parent = y;
+        }
+        replaceChild(tree, z, y);
+        NODE(tree, y).left = NODE(tree, z).left;
+        NODE(tree, NODE(tree, y).left).parent = y;
+        NODE(tree, y).red = NODE(tree, z).red;
+    }
+    NODE(tree, z).linked = 0;
+    tree->size--;
+
+    if (!removedBlack)
+        return true;
+
+    // x carries an extra black: push it up or fix it with rotations
+    while (x != tree->root && !IS_RED(tree, x))
+    {
+        if (x == NODE(tree, xParent).left)
+        {
+            int w = NODE(tree, xParent).right;
+            if (IS_RED(tree, w))
+            {
+                NODE(tree, w).red = 0;
+                NODE(tree, xParent).red = 1;
+                rotateLeft(tree, xParent);
+                w = NODE(tree, xParent).right;
+            }
+            if (!IS_RED(tree, NODE(tree, w).left) && !IS_RED(tree, NODE(tree, w).right))
+            {
+                NODE(tree, w).red = 1;
+                x = xParent;
+                xParent = NODE(tree, x).parent;
+                continue;
+            }
+            if (!IS_RED(tree, NODE(tree, w).right))
+            {
+                NODE(tree, NODE(tree, w).left).red = 0;
+                NODE(tree, w).red = 1;
+                rotateRight(tree, w);
+                w = NODE(tree, xParent).right;
+            }
+            NODE(tree, w).red = NODE(tree, xParent).red;
+            NODE(tree, xParent).red = 0;
+            NODE(tree, NODE(tree, w).right).red = 0;
+            rotateLeft(tree, xParent);
+        }
+        else
+        {
+            int w = NODE(tree, xParent).left;
+            if (IS_RED(tree, w))
+            {
+                NODE(tree, w).red = 0;
+                NODE(tree, xParent).red = 1;
+                rotateRight(tree, xParent);
+                w = NODE(tree, xParent).left;
+            }
+            if (!IS_RED(tree, NODE(tree, w).left) && !IS_RED(tree, NODE(tree, w).right))
+            {
+                NODE(tree, w).red = 1;
+                x = xParent;
+                xParent = NODE(tree, x).parent;
+                continue;
+            }
+            if (!IS_RED(tree, NODE(tree, w).left))
+            {
+                NODE(tree, NODE(tree, w).right).red = 0;
+                NODE(tree, w).red = 1;
+                rotateLeft(tree, w);
+                w = NODE(tree, xParent).left;
+            }
+            NODE(tree, w).red = NODE(tree, xParent).red;
+            NODE(tree, xParent).red = 0;
+            NODE(tree, NODE(tree, w).left).red = 0;
+            rotateRight(tree, xParent);
+        }
+        x = tree->root;
+        break;
+    }
+    if (x != RB_NIL)
+        NODE(tree, x).red = 0;
+    return true;
+}
+
+// Remove the smallest element and return its index, RB_NIL if empty
+int rbTreePopFirst(RBTree *tree)
+{
+    int first = tree->first;
+    if (first != RB_NIL)
+        rbTreeRemove(tree, first);
+    return first;
+}
+
+bool rbTreeContains(RBTree *tree, int index)
+{
+    return index >= 0 && index < tree->capacity && NODE(tree, index).linked;
+}
+
+// Number of elements; takes void * to match getSize() on a Queue
+int rbTreeSize(void *tree)
+{
+    return tree == NULL ? 0 : ((RBTree *)tree)->size;
+}
+
+void destroyRBTree(RBTree *tree)
+{
+    if (tree == NULL)
+        return;
+
+    free(tree->nodes);
+    free(tree);
+}
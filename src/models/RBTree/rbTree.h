@@ -0,0 +1,40 @@
+#pragma once
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RB_NIL (-1)
+
+// Red-black tree ordered by (key, tie). Like the ready heap, elements are
+// named by a dense caller-side index (the PCB's slab index) and the node
+// for index i lives at nodes[i], so inserting never allocates once the
+// array is big enough. The leftmost node is cached for O(1) peeks.
+typedef struct RBNode
+{
+    int64_t key;
+    int tie;           // Final tie-break when keys are equal
+    int left;          // Node indices, RB_NIL for none
+    int right;
+    int parent;
+    char red;
+    char linked;       // Node is in the tree
+} RBNode;
+
+typedef struct RBTree
+{
+    RBNode *nodes;     // Indexed by the caller's index
+    int capacity;
+    int root;
+    int first;         // Leftmost node, RB_NIL when empty
+    int size;
+} RBTree;
+
+RBTree *createRBTree(int capacity);
+bool rbTreeInsert(RBTree *tree, int64_t key, int tie, int index);
+int rbTreeFirst(RBTree *tree);
+int rbTreePopFirst(RBTree *tree);
+bool rbTreeRemove(RBTree *tree, int index);
+bool rbTreeContains(RBTree *tree, int index);
+int rbTreeSize(void *tree);
+void destroyRBTree(RBTree *tree);
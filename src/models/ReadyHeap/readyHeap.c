@@ -0,0 +1,224 @@
+#include <string.h>
+#include "readyHeap.h"
+
+#define ARITY 4
+#define CACHE_LINE 64
+// entries[1..4] (the root's children) start a cache line, and so does every
+// later group of siblings
+#define ENTRY_PAD (CACHE_LINE / sizeof(ReadyEntry) - 1)
+
+#define PARENT(i) (((i) - 1) / ARITY)
+#define FIRST_CHILD(i) (ARITY * (i) + 1)
+
+// Strict "a comes out before b"
+#define ENTRY_LESS(a, b) ((a).key < (b).key || ((a).key == (b).key && (a).tie < (b).tie))
+
+// Allocate room for `capacity` entries with the padding described above
+static bool allocEntries(ReadyHeap *heap, int capacity)
+{
+    void *block;
+    if (posix_memalign(&block, CACHE_LINE, sizeof(ReadyEntry) * (capacity + ENTRY_PAD)) != 0)
+        return false;
+
+    ReadyEntry *entries = (ReadyEntry *)block + ENTRY_PAD;
+    if (heap->entries != NULL)
+        memcpy(entries, heap->entries, sizeof(ReadyEntry) * heap->size);
+    free(heap->block);
+    heap->block = block;
+    heap->entries = entries;
+    heap->capacity = capacity;
+    return true;
+}
+
+// Make position[index] addressable
+static bool ensurePosition(ReadyHeap *heap, int index)
+{
+    if (index < heap->positionCapacity)
+        return true;
+
+    int capacity = heap->positionCapacity ? heap->positionCapacity : 64;
+    while (capacity <= index)
+        capacity *= 2;
+    int *position = realloc(heap->position, sizeof(int) * capacity);
+    if (position == NULL)
+        return false;
+    for (int i = heap->positionCapacity; i < capacity; i++)
+        position[i] = -1;
+    heap->position = position;
+    heap->positionCapacity = capacity;
+    return true;
+}
+
+// Create an empty heap with room for `capacity` entries; it grows on demand
+ReadyHeap *createReadyHeap(int capacity)
+{
+    ReadyHeap *heap = calloc(1, sizeof(*heap));
+    if (heap == NULL)
+        return NULL;
+    if (capacity < ARITY)
+        capacity = ARITY;
+    if (!allocEntries(heap, capacity) || !ensurePosition(heap, capacity - 1))
+    {
+        printf("Error in allocating memory for ready heap\n");
+        destroyReadyHeap(heap);
+        return NULL;
+    }
+    return heap;
+}
+
+// Move the hole at slot i up until `entry` fits there, then place it
+static void siftUp(ReadyHeap *heap, int i, ReadyEntry entry)
+{
+    while (i > 0)
+    {
+        int parent = PARENT(i);
+        if (!ENTRY_LESS(entry, heap->entries[parent]))
+            break;
+        heap->entries[i] = heap->entries[parent];
+        heap->position[heap->entries[i].index] = i;
+        i = parent;
+    }
+    heap->entries[i] = entry;
+    heap->position[entry.index] = i;
+}
+
+// Move the hole at slot i down until `entry` fits there, then place it
+static void siftDown(ReadyHeap *heap, int i, ReadyEntry entry)
+{
+    while (1)
+    {
+        int first = FIRST_CHILD(i);
+        if (first >= heap->size)
+            break;
+        int last = first + ARITY < heap->size ? first + ARITY : heap->size;
+        int best = first;
+        for (int child = first + 1; child < last; child++)
+        {
+            if (ENTRY_LESS(heap->entries[child], heap->entries[best]))
+                best = child;
+        }
+        if (!ENTRY_LESS(heap->entries[best], entry))
+            break;
+        heap->entries[i] = heap->entries[best];
+        heap->position[heap->entries[i].index] = i;
+        i = best;
+    }
+    heap->entries[i] = entry;
+    heap->position[entry.index] = i;
+}
+
+// Add an element. Returns false if out of memory.
+bool readyHeapPush(ReadyHeap *heap, int64_t key, int tie, int index)
+{
+    if (heap->size == heap->capacity && !allocEntries(heap, heap->capacity * 2))
+    {
+        printf("Error in growing ready heap\n");
+        return false;
+    }
+    if (!ensurePosition(heap, index))
+    {
+        printf("Error in growing ready heap\n");
+        return false;
+    }
+
+    ReadyEntry entry = {key, tie, index};
+    siftUp(heap, heap->size++, entry);
+    return true;
+}
+
+// Index of the first element to come out, -1 if empty
+int readyHeapPeek(ReadyHeap *heap)
+{
+    return heap->size > 0 ? heap->entries[0].index : -1;
+}
+
+// Remove the first element and return its index, -1 if empty
+int readyHeapPop(ReadyHeap *heap)
+{
+    if (heap->size == 0)
+        return -1;
+
+    int top = heap->entries[0].index;
+    heap->position[top] = -1;
+    if (--heap->size > 0)
+        siftDown(heap, 0, heap->entries[heap->size]);
+    return top;
+}
+
+// Pop the first element and push a new one in a single sift
+int readyHeapReplaceTop(ReadyHeap *heap, int64_t key, int tie, int index)
+{
+    if (heap->size == 0)
+    {
+        readyHeapPush(heap, key, tie, index);
+        return -1;
+    }
+    if (!ensurePosition(heap, index))
+    {
+        printf("Error in growing ready heap\n");
+        return -1;
+    }
+
+    int top = heap->entries[0].index;
+    heap->position[top] = -1;
+    ReadyEntry entry = {key, tie, index};
+    siftDown(heap, 0, entry);
+    return top;
+}
+
+// Give an element a new key (either direction) and restore the order
+void readyHeapUpdate(ReadyHeap *heap, int index, int64_t key)
+{
+    if (!readyHeapContains(heap, index))
+        return;
+
+    int i = heap->position[index];
+    ReadyEntry entry = heap->entries[i];
+    entry.key = key;
+    if (i > 0 && ENTRY_LESS(entry, heap->entries[PARENT(i)]))
+        siftUp(heap, i, entry);
+    else
+        siftDown(heap, i, entry);
+}
+
+// Remove an arbitrary element. Returns false if it is not in the heap.
+bool readyHeapRemove(ReadyHeap *heap, int index)
+{
+    if (!readyHeapContains(heap, index))
+        return false;
+
+    int i = heap->position[index];
+    heap->position[index] = -1;
+    if (i == --heap->size)
+        return true;
+
+    // Fill the hole with the last entry and let it settle either way
+    ReadyEntry last = heap->entries[heap->size];
+    if (i > 0 && ENTRY_LESS(last, heap->entries[PARENT(i)]))
+        siftUp(heap, i, last);
+    else
+        siftDown(heap, i, last);
+    return true;
+}
+
+bool readyHeapContains(ReadyHeap *heap, int index)
+{
+    return index >= 0 && index < heap->positionCapacity && heap->position[index] >= 0;
+}
+
+// Number of elements; takes void * to match getSize() on a Queue
+int readyHeapSize(void *heap)
+{
+    return heap == NULL ? 0 : ((ReadyHeap *)heap)->size;
+}
+
+// Destroy the heap; the elements themselves belong to the caller
+void destroyReadyHeap(ReadyHeap *heap)
+{
+    if (heap == NULL)
+        return;
+
+    free(heap->block);
+    free(heap->position);
+    free(heap);
+}
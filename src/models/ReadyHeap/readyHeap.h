@@ -0,0 +1,46 @@
+#pragma once
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Ready queue specialized for the priority policies. Entries are small
+// (key, tie, index) records stored inline in one array, so sifting never
+// touches a PCB and every comparison is an inlined integer compare instead
+// of a call through a function pointer. The tree is 4-ary and laid out so
+// the four children of a node share one cache line.
+//
+// Entries are named by a dense caller-side index (the PCB's slab index);
+// the heap tracks where each index sits, so any entry can be re-keyed or
+// removed in O(log n).
+typedef struct ReadyEntry
+{
+    int64_t key;   // Policy key, see READY_KEY()
+    int tie;       // Final tie-break when keys are equal (process id)
+    int index;     // Caller's handle for the element
+} ReadyEntry;
+
+typedef struct ReadyHeap
+{
+    ReadyEntry *entries;   // entries[0] is the root
+    void *block;           // Allocation backing entries
+    int capacity;
+    int size;
+    int *position;         // index -> slot in entries, -1 when absent
+    int positionCapacity;
+} ReadyHeap;
+
+// Order by `primary`, then by `secondary` (both signed ints), as one integer
+#define READY_KEY(primary, secondary) \
+    ((int64_t)(primary) * 4294967296LL + (int64_t)((uint32_t)(secondary) ^ 0x80000000u))
+
+ReadyHeap *createReadyHeap(int capacity);
+bool readyHeapPush(ReadyHeap *heap, int64_t key, int tie, int index);
+int readyHeapPeek(ReadyHeap *heap);
+int readyHeapPop(ReadyHeap *heap);
+int readyHeapReplaceTop(ReadyHeap *heap, int64_t key, int tie, int index);
+void readyHeapUpdate(ReadyHeap *heap, int index, int64_t key);
+bool readyHeapRemove(ReadyHeap *heap, int index);
+bool readyHeapContains(ReadyHeap *heap, int index);
+int readyHeapSize(void *heap);
+void destroyReadyHeap(ReadyHeap *heap);
@@ -0,0 +1,78 @@
+#include "readyHeap.h"
+
+// Behavioral check of the re-keying API: `make check` builds and runs it.
+// Exits non-zero and names the first step that went wrong.
+
+#define CHECK_JOBS 200
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("readyHeap check failed: %s\n", what);
+        failures++;
+    }
+}
+
+// Pop everything and make sure the keys come out in order
+static void expectSorted(ReadyHeap *heap, const int64_t *keys, int count, const char *what)
+{
+    int64_t last = INT64_MIN;
+    int popped = 0;
+    int index;
+    while ((index = readyHeapPop(heap)) != -1)
+    {
+        expect(keys[index] >= last, what);
+        expect(!readyHeapContains(heap, index), "popped index is still contained");
+        last = keys[index];
+        popped++;
+    }
+    expect(popped == count, what);
+}
+
+int main()
+{
+    ReadyHeap *heap = createReadyHeap(4);
+    int64_t keys[CHECK_JOBS];
+
+    // Scrambled keys, so pushes, updates and removes hit every depth
+    for (int i = 0; i < CHECK_JOBS; i++)
+    {
+        keys[i] = (i * 7919) % CHECK_JOBS;
+        readyHeapPush(heap, keys[i], i, i);
+    }
+
+    // Re-key every third element, half of them up and half down
+    for (int i = 0; i < CHECK_JOBS; i += 3)
+    {
+        keys[i] = i % 2 ? keys[i] + CHECK_JOBS : -keys[i];
+        readyHeapUpdate(heap, i, keys[i]);
+    }
+    expect(readyHeapPeek(heap) >= 0 && keys[readyHeapPeek(heap)] <= 0, "update did not move the smallest key to the top");
+
+    // Remove every fifth element, then remove one twice
+    int removed = 0;
+    for (int i = 0; i < CHECK_JOBS; i += 5)
+    {
+        expect(readyHeapRemove(heap, i), "remove of a contained index failed");
+        expect(!readyHeapContains(heap, i), "removed index is still contained");
+        removed++;
+    }
+    expect(!readyHeapRemove(heap, 0), "second remove of the same index succeeded");
+    expect(readyHeapSize(heap) == CHECK_JOBS - removed, "size is wrong after removes");
+
+    // The top goes out and the new element takes its place in order
+    int top = readyHeapPeek(heap);
+    keys[0] = CHECK_JOBS * 4;
+    expect(readyHeapReplaceTop(heap, keys[0], 0, 0) == top, "replaceTop returned the wrong index");
+    expect(readyHeapContains(heap, 0) && !readyHeapContains(heap, top), "replaceTop did not swap the elements");
+
+    expectSorted(heap, keys, CHECK_JOBS - removed, "elements came out of order");
+    destroyReadyHeap(heap);
+
+    if (failures == 0)
+        printf("readyHeap check passed\n");
+    return failures == 0 ? 0 : 1;
+}
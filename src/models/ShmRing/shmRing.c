@@ -0,0 +1,93 @@
+#include <string.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include "shmRing.h"
+#include "futex.h"
+
+#define SLOT(ring, index) ((ring)->slots + (size_t)((index) & ((ring)->capacity - 1)) * (ring)->elementSize)
+
+// Create a ring holding at least `capacity` elements of `elementSize` bytes
+ShmRing *createShmRing(size_t elementSize, int capacity)
+{
+    unsigned int slots = 1;
+    while (slots < (unsigned int)capacity)
+        slots *= 2;
+
+    int shmId = shmget(IPC_PRIVATE, sizeof(ShmRing) + (size_t)slots * elementSize, 0600 | IPC_CREAT);
+    if (shmId == -1)
+    {
+        perror("Error creating ring buffer");
+        return NULL;
+    }
+    ShmRing *ring = shmat(shmId, NULL, 0);
+    shmctl(shmId, IPC_RMID, NULL); // Goes away with the last process that maps it
+    if (ring == (void *)-1)
+    {
+        perror("Error attaching ring buffer");
+        return NULL;
+    }
+
+    // A fresh segment is zeroed: head, tail and the flags start at 0
+    ring->capacity = slots;
+    ring->elementSize = elementSize;
+    ring->shmId = shmId;
+    return ring;
+}
+
+// Copy an element in behind the last one. It becomes visible to the consumer
+// at the next shmRingPublish(). Returns false if the ring is full.
+bool shmRingPush(ShmRing *ring, const void *element)
+{
+    if (ring->staged - ring->headCache == ring->capacity)
+    {
+        ring->headCache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (ring->staged - ring->headCache == ring->capacity)
+            return false;
+    }
+    memcpy(SLOT(ring, ring->staged), element, ring->elementSize);
+    ring->staged++;
+    return true;
+}
+
+// Hand every pushed element to the consumer, waking it if it sleeps
+void shmRingPublish(ShmRing *ring)
+{
+    if (ring->staged == ring->tail)
+        return;
+    // Sequentially consistent so it orders against the consumer's
+    // consumerWaiting store followed by its tail load
+    __atomic_store_n(&ring->tail, ring->staged, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->consumerWaiting, __ATOMIC_SEQ_CST))
+        futex_wake_all((volatile int *)&ring->tail);
+}
+
+// Take the oldest published element. Returns false if there is none.
+bool shmRingPop(ShmRing *ring, void *element)
+{
+    unsigned int head = ring->head;
+    if (head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE))
+        return false;
+    memcpy(element, SLOT(ring, head), ring->elementSize);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Same as shmRingPop(), but sleeps until an element is published
+void shmRingPopWait(ShmRing *ring, void *element)
+{
+    while (!shmRingPop(ring, element))
+    {
+        __atomic_store_n(&ring->consumerWaiting, 1, __ATOMIC_SEQ_CST);
+        unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST);
+        if (tail == ring->head)
+            futex_wait((volatile int *)&ring->tail, (int)tail);
+        __atomic_store_n(&ring->consumerWaiting, 0, __ATOMIC_SEQ_CST);
+    }
+}
+
+// Unmap the ring from this process
+void destroyShmRing(ShmRing *ring)
+{
+    if (ring != NULL)
+        shmdt(ring);
+}
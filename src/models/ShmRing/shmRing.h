@@ -0,0 +1,42 @@
+#pragma once
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+
+#define SHM_RING_CACHE_LINE 64
+
+// Single-producer/single-consumer ring of fixed-size elements in a System V
+// shared memory segment. The segment is marked for removal as soon as it is
+// attached, so it lives exactly as long as some process maps it: create the
+// ring before fork() and both sides inherit it, with nothing to clean up
+// after a crash.
+//
+// head and tail are free-running counters on their own cache lines; the
+// producer only writes tail, the consumer only writes head. Elements pushed
+// by the producer stay invisible until shmRingPublish(), so a burst costs
+// one release store. The consumer may sleep on tail with a futex; the
+// producer only makes the wake-up syscall when it has said so.
+typedef struct ShmRing
+{
+    unsigned int capacity;     // Power of two
+    unsigned int elementSize;
+    int shmId;
+
+    // Producer side
+    volatile unsigned int tail __attribute__((aligned(SHM_RING_CACHE_LINE))); // Published elements
+    unsigned int staged;       // Pushed elements, >= tail
+    unsigned int headCache;    // Last head seen, saves reading the consumer's line
+
+    // Consumer side
+    volatile unsigned int head __attribute__((aligned(SHM_RING_CACHE_LINE))); // Consumed elements
+    volatile int consumerWaiting; // Consumer is (about to be) asleep on tail
+
+    char slots[] __attribute__((aligned(SHM_RING_CACHE_LINE)));
+} ShmRing;
+
+ShmRing *createShmRing(size_t elementSize, int capacity);
+bool shmRingPush(ShmRing *ring, const void *element);
+void shmRingPublish(ShmRing *ring);
+bool shmRingPop(ShmRing *ring, void *element);
+void shmRingPopWait(ShmRing *ring, void *element);
+void destroyShmRing(ShmRing *ring);
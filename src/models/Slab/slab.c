@@ -0,0 +1,113 @@
+#include "slab.h"
+
+// Create a slab for objects of objectSize bytes, allocated objectsPerChunk at a time
+Slab *createSlab(size_t objectSize, int objectsPerChunk)
+{
+    Slab *slab = malloc(sizeof(*slab));
+    if (slab == NULL)
+        return NULL;
+
+    // Free objects hold the free-list link and their index, and must stay
+    // pointer aligned
+    if (objectSize < 2 * sizeof(void *))
+        objectSize = 2 * sizeof(void *);
+    objectSize = (objectSize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+    slab->objectSize = objectSize;
+    slab->objectsPerChunk = objectsPerChunk > 0 ? objectsPerChunk : 1;
+    slab->chunks = NULL;
+    slab->chunkCount = 0;
+    slab->chunkCapacity = 0;
+    slab->freeList = NULL;
+    slab->used = slab->objectsPerChunk; // Forces a chunk on first allocation
+    slab->live = 0;
+    return slab;
+}
+
+// Add one chunk; existing objects are never moved
+static bool addChunk(Slab *slab)
+{
+    if (slab->chunkCount == slab->chunkCapacity)
+    {
+        int capacity = slab->chunkCapacity ? slab->chunkCapacity * 2 : 8;
+        char **chunks = realloc(slab->chunks, sizeof(char *) * capacity);
+        if (chunks == NULL)
+            return false;
+        slab->chunks = chunks;
+        slab->chunkCapacity = capacity;
+    }
+
+    char *chunk = malloc(slab->objectSize * slab->objectsPerChunk);
+    if (chunk == NULL)
+        return false;
+    slab->chunks[slab->chunkCount++] = chunk;
+    slab->used = 0;
+    return true;
+}
+
+// Get an uninitialized object, or NULL if out of memory
+void *slabAlloc(Slab *slab)
+{
+    int index;
+    return slabAllocIndexed(slab, &index);
+}
+
+// Return an object to the slab
+void slabFree(Slab *slab, void *object)
+{
+    slabFreeIndexed(slab, object, -1);
+}
+
+// Get an uninitialized object and its index, or NULL if out of memory
+void *slabAllocIndexed(Slab *slab, int *index)
+{
+    void *object;
+    if (slab->freeList != NULL)
+    {
+        object = slab->freeList;
+        slab->freeList = *(void **)object;
+        *index = ((int *)object)[sizeof(void *) / sizeof(int)];
+    }
+    else
+    {
+        if (slab->used == slab->objectsPerChunk && !addChunk(slab))
+        {
+            printf("Error in allocating memory for slab\n");
+            return NULL;
+        }
+        *index = (slab->chunkCount - 1) * slab->objectsPerChunk + slab->used;
+        object = slab->chunks[slab->chunkCount - 1] + slab->objectSize * slab->used++;
+    }
+    slab->live++;
+    return object;
+}
+
+// Return an object to the slab, remembering its index for reuse
+void slabFreeIndexed(Slab *slab, void *object, int index)
+{
+    if (object == NULL)
+        return;
+
+    *(void **)object = slab->freeList;
+    ((int *)object)[sizeof(void *) / sizeof(int)] = index;
+    slab->freeList = object;
+    slab->live--;
+}
+
+// Object with the given index; it must have been handed out before
+void *slabAt(Slab *slab, int index)
+{
+    return slab->chunks[index / slab->objectsPerChunk] + slab->objectSize * (index % slab->objectsPerChunk);
+}
+
+// Destroy the slab and every object in it
+void destroySlab(Slab *slab)
+{
+    if (slab == NULL)
+        return;
+
+    for (int i = 0; i < slab->chunkCount; i++)
+        free(slab->chunks[i]);
+    free(slab->chunks);
+    free(slab);
+}
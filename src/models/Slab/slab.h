@@ -0,0 +1,31 @@
+#pragma once
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+
+// Fixed-size object allocator. Objects live contiguously in chunks that are
+// never moved, so pointers stay valid while the slab grows. Freed objects
+// are kept on a free list and reused, making alloc/free O(1) with no
+// per-object malloc.
+// Objects also have a dense index (chunk * objectsPerChunk + offset) that
+// slabAt() turns back into a pointer. Slabs used through the *Indexed calls
+// must be freed through them too, so recycled objects keep their index.
+typedef struct Slab
+{
+    size_t objectSize;
+    int objectsPerChunk;
+    char **chunks;
+    int chunkCount;
+    int chunkCapacity;
+    void *freeList;     // Next pointer stored in the first bytes of a free object
+    int used;           // Objects handed out from the newest chunk
+    int live;           // Objects currently allocated
+} Slab;
+
+Slab *createSlab(size_t objectSize, int objectsPerChunk);
+void *slabAlloc(Slab *slab);
+void slabFree(Slab *slab, void *object);
+void *slabAllocIndexed(Slab *slab, int *index);
+void slabFreeIndexed(Slab *slab, void *object, int index);
+void *slabAt(Slab *slab, int index);
+void destroySlab(Slab *slab);
@@ -0,0 +1,206 @@
+#include <math.h>
+#include <string.h>
+#include "stats.h"
+
+void runningStatsInit(RunningStats *stats)
+{
+    stats->count = 0;
+    stats->mean = 0;
+    stats->m2 = 0;
+}
+
+void runningStatsAdd(RunningStats *stats, double value)
+{
+    stats->count++;
+    double delta = value - stats->mean;
+    stats->mean += delta / stats->count;
+    stats->m2 += delta * (value - stats->mean);
+}
+
+// Chan et al.'s pairwise combination of two accumulators
+void runningStatsMerge(RunningStats *into, const RunningStats *from)
+{
+    if (from->count == 0)
+        return;
+    long count = into->count + from->count;
+    double delta = from->mean - into->mean;
+    into->mean += delta * from->count / count;
+    into->m2 += from->m2 + delta * delta * ((double)into->count * from->count / count);
+    into->count = count;
+}
+
+double runningStatsMean(const RunningStats *stats)
+{
+    return stats->mean;
+}
+
+double runningStatsStd(const RunningStats *stats)
+{
+    return stats->count > 0 ? sqrt(stats->m2 / stats->count) : 0;
+}
+
+// gamma = (1 + a) / (1 - a) makes the bucket midpoint within a of every
+// value in the bucket
+static double sketch_gamma()
+{
+    return (1 + QUANTILE_SKETCH_ACCURACY) / (1 - QUANTILE_SKETCH_ACCURACY);
+}
+
+void quantileSketchInit(QuantileSketch *sketch)
+{
+    memset(sketch, 0, sizeof(*sketch));
+}
+
+void quantileSketchAdd(QuantileSketch *sketch, double value)
+{
+    if (sketch->count == 0 || value < sketch->min)
+        sketch->min = value;
+    if (sketch->count == 0 || value > sketch->max)
+        sketch->max = value;
+    sketch->count++;
+    if (value != floor(value))
+        sketch->fractional = true;
+
+    if (value < QUANTILE_SKETCH_MIN)
+    {
+        sketch->low++;
+        return;
+    }
+    // Bucket 0 starts right at QUANTILE_SKETCH_MIN
+    int index = (int)ceil(log(value / QUANTILE_SKETCH_MIN) / log(sketch_gamma()));
+    if (index >= QUANTILE_SKETCH_BUCKETS)
+        index = QUANTILE_SKETCH_BUCKETS - 1;
+    sketch->buckets[index]++;
+}
+
+void quantileSketchMerge(QuantileSketch *into, const QuantileSketch *from)
+{
+    if (from->count == 0)
+        return;
+    if (into->count == 0 || from->min < into->min)
+        into->min = from->min;
+    if (into->count == 0 || from->max > into->max)
+        into->max = from->max;
+    into->count += from->count;
+    into->low += from->low;
+    into->fractional = into->fractional || from->fractional;
+    for (int i = 0; i < QUANTILE_SKETCH_BUCKETS; i++)
+        into->buckets[i] += from->buckets[i];
+}
+
+// Nearest rank: the value with rank ceil(q * count), counting from 1, so
+// that at least a fraction q of the values are at or below it. Comes from
+// its bucket, so it is within the sketch accuracy of that value, and exact
+// for whole numbers below 50. 0 <= q <= 1. Returns 0 when empty.
+double quantileSketchQuantile(const QuantileSketch *sketch, double q)
+{
+    if (sketch->count == 0)
+        return 0;
+    if (q <= 0)
+        return sketch->min;
+    if (q >= 1)
+        return sketch->max;
+
+    long rank = (long)ceil(q * sketch->count);
+    if (rank < 1)
+        rank = 1;
+    long seen = sketch->low;
+    if (seen >= rank)
+        return sketch->min;
+
+    double gamma = sketch_gamma();
+    for (int i = 0; i < QUANTILE_SKETCH_BUCKETS; i++)
+    {
+        seen += sketch->buckets[i];
+        if (seen >= rank)
+        {
+            // Bucket i holds (MIN * gamma^(i-1), MIN * gamma^i]
+            double value = QUANTILE_SKETCH_MIN * pow(gamma, i) * 2 / (gamma + 1);
+            if (!sketch->fractional)
+                value = round(value);
+            return fmin(fmax(value, sketch->min), sketch->max);
+        }
+    }
+    return sketch->max;
+}
+
+// Slot g * LATENCY_SUB_BUCKETS + sub: group g > 0 holds the values whose
+// highest set bit is g + LATENCY_SUB_BUCKET_BITS - 1, `sub` is the next
+// LATENCY_SUB_BUCKET_BITS bits below it
+static int latency_slot(uint64_t value)
+{
+    if (value < LATENCY_SUB_BUCKETS)
+        return (int)value;
+    int top = 63 - __builtin_clzll(value);
+    int group = top - LATENCY_SUB_BUCKET_BITS + 1;
+    int sub = (int)((value >> (group - 1)) & (LATENCY_SUB_BUCKETS - 1));
+    return group * LATENCY_SUB_BUCKETS + sub;
+}
+
+// Largest value that lands in `slot`
+static uint64_t latency_slot_high(int slot)
+{
+    int group = slot / LATENCY_SUB_BUCKETS;
+    uint64_t sub = slot % LATENCY_SUB_BUCKETS;
+    if (group == 0)
+        return sub;
+    uint64_t low = (LATENCY_SUB_BUCKETS + sub) << (group - 1);
+    return low + ((uint64_t)1 << (group - 1)) - 1;
+}
+
+void latencyHistogramInit(LatencyHistogram *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void latencyHistogramRecord(LatencyHistogram *histogram, uint64_t value)
+{
+    if (histogram->count == 0 || value < histogram->min)
+        histogram->min = value;
+    if (value > histogram->max)
+        histogram->max = value;
+    histogram->count++;
+    histogram->sum += value;
+    histogram->counts[latency_slot(value)]++;
+}
+
+void latencyHistogramMerge(LatencyHistogram *into, const LatencyHistogram *from)
+{
+    if (from->count == 0)
+        return;
+    if (into->count == 0 || from->min < into->min)
+        into->min = from->min;
+    if (from->max > into->max)
+        into->max = from->max;
+    into->count += from->count;
+    into->sum += from->sum;
+    for (int i = 0; i < LATENCY_HISTOGRAM_SLOTS; i++)
+        into->counts[i] += from->counts[i];
+}
+
+// Smallest value that at least `percentile`% of the records do not exceed,
+// reported as the top of its slot like HdrHistogram. 0 when empty.
+uint64_t latencyHistogramPercentile(const LatencyHistogram *histogram, double percentile)
+{
+    if (histogram->count == 0)
+        return 0;
+    uint64_t rank = (uint64_t)ceil(percentile / 100 * histogram->count);
+    if (rank < 1)
+        rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_HISTOGRAM_SLOTS; i++)
+    {
+        seen += histogram->counts[i];
+        if (seen >= rank)
+        {
+            uint64_t value = latency_slot_high(i);
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+double latencyHistogramMean(const LatencyHistogram *histogram)
+{
+    return histogram->count > 0 ? histogram->sum / histogram->count : 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "stdlib.h"
+#include "stdio.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Streaming statistics that take one value at a time in O(1) and use the
+// same memory after ten jobs or ten million. All of them are plain values
+// with no pointers, so a snapshot is a struct copy.
+
+// Count, mean and sum of squared deviations (Welford's algorithm), which
+// stays accurate where summing x and x^2 would cancel catastrophically.
+typedef struct RunningStats
+{
+    long count;
+    double mean;
+    double m2;      // Sum of (x - mean)^2
+} RunningStats;
+
+void runningStatsInit(RunningStats *stats);
+void runningStatsAdd(RunningStats *stats, double value);
+void runningStatsMerge(RunningStats *into, const RunningStats *from);
+double runningStatsMean(const RunningStats *stats);
+double runningStatsStd(const RunningStats *stats);   // Population std
+
+// Log-bucketed quantile sketch: value x > 0 is counted in bucket
+// ceil(log(x) / log(gamma)), so any quantile comes back within
+// QUANTILE_SKETCH_ACCURACY of the true value, relative. Merging is adding
+// bucket counts. Values below QUANTILE_SKETCH_MIN share one bucket, values
+// past the top bucket are clamped into it; min and max are kept exactly.
+// While every value is a whole number, quantiles are rounded to one, which
+// is exact below 50 where the bucket error is under a half.
+#define QUANTILE_SKETCH_ACCURACY 0.01
+#define QUANTILE_SKETCH_MIN 1e-3
+#define QUANTILE_SKETCH_BUCKETS 1536 // Reaches past 2^31 from the minimum
+
+typedef struct QuantileSketch
+{
+    unsigned int buckets[QUANTILE_SKETCH_BUCKETS];
+    unsigned int low;   // Values below QUANTILE_SKETCH_MIN, zero included
+    long count;
+    double min, max;
+    bool fractional;    // Some value was not a whole number
+} QuantileSketch;
+
+void quantileSketchInit(QuantileSketch *sketch);
+void quantileSketchAdd(QuantileSketch *sketch, double value);
+void quantileSketchMerge(QuantileSketch *into, const QuantileSketch *from);
+double quantileSketchQuantile(const QuantileSketch *sketch, double q);
+
+// HDR-style log-linear histogram of non-negative integers (latencies in ns):
+// values below 2^LATENCY_SUB_BUCKET_BITS are counted exactly, larger ones
+// in LATENCY_SUB_BUCKETS linear steps per power of two, so every recorded
+// value is known to within about 3% across the whole 64-bit range.
+#define LATENCY_SUB_BUCKET_BITS 5
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_HISTOGRAM_SLOTS ((64 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+typedef struct LatencyHistogram
+{
+    uint64_t counts[LATENCY_HISTOGRAM_SLOTS];
+    uint64_t count;
+    uint64_t min, max;
+    double sum;
+} LatencyHistogram;
+
+void latencyHistogramInit(LatencyHistogram *histogram);
+void latencyHistogramRecord(LatencyHistogram *histogram, uint64_t value);
+void latencyHistogramMerge(LatencyHistogram *into, const LatencyHistogram *from);
+uint64_t latencyHistogramPercentile(const LatencyHistogram *histogram, double percentile);
+double latencyHistogramMean(const LatencyHistogram *histogram);
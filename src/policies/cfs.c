@@ -0,0 +1,187 @@
+#include "scheduler.h"
+#include "policies/policy.h"
+#include "models/RBTree/rbTree.h"
+
+// Completely Fair Scheduler: every job accrues virtual runtime at a rate
+// inversely proportional to its weight, and the job with the least virtual
+// runtime runs. The running job is preempted once it has run for at least
+// `granularity` ticks and someone else is strictly behind it.
+
+#define CFS_DEFAULT_GRANULARITY 2
+#define NICE_0_WEIGHT 1024
+#define VRUNTIME_SHIFT 10 // Fixed-point fraction bits of vruntime
+
+// Weights for nice -20..19, each step is about 1.25x (the Linux table)
+static const int nice_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+    9548, 7620, 6100, 4904, 3906,
+    3121, 2501, 1991, 1586, 1277,
+    1024, 820, 655, 526, 423,
+    335, 272, 215, 172, 137,
+    110, 87, 70, 56, 45,
+    36, 29, 23, 18, 15,
+};
+
+typedef struct {
+    RBTree *tree;            // Ready jobs keyed by vruntime
+    int granularity;         // Minimum ticks before the running job can be preempted
+    long long min_vruntime;  // Never decreases; new jobs start here
+    int slice;               // Ticks the running job has had since it was dispatched
+} cfs_state_t;
+
+// Priority 0..10 (0 highest) maps to nice -10..10, priority 5 is nice 0
+static int cfs_weight(PCB *process)
+{
+    int nice = 2 * process->priority - 10;
+    if (nice < -20)
+        nice = -20;
+    if (nice > 19)
+        nice = 19;
+    return nice_to_weight[nice + 20];
+}
+
+// Virtual runtime one tick of real runtime costs this job. Charged per
+// tick so a multi-tick jump adds up to the same as single ticks.
+static long long cfs_tick_cost(PCB *process)
+{
+    return ((long long)NICE_0_WEIGHT << VRUNTIME_SHIFT) / cfs_weight(process);
+}
+
+// -q optionally sets the granularity
+static int cfs_configure(policy_options_t *options)
+{
+    if (options->quanta_count > 1 || options->levels || options->boost_period ||
+        (options->quanta_count == 1 && options->quanta[0] <= 0))
+    {
+        printf("Error: Invalid arguments\n");
+        return -1;
+    }
+    if (options->quanta_count == 0)
+    {
+        options->quanta[0] = CFS_DEFAULT_GRANULARITY;
+        options->quanta_count = 1;
+    }
+    return 0;
+}
+
+static void *cfs_create(const policy_options_t *options, int expected_jobs)
+{
+    cfs_state_t *cfs = calloc(1, sizeof(*cfs));
+    if (!cfs)
+        return NULL;
+    cfs->tree = createRBTree(expected_jobs);
+    if (!cfs->tree)
+    {
+        free(cfs);
+        return NULL;
+    }
+    cfs->granularity = options->quanta[0];
+    printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+    printf("Scheduler started with Completely Fair Scheduler algorithm, granularity = %d\n", cfs->granularity);
+    return cfs;
+}
+
+static void cfs_destroy(void *state)
+{
+    cfs_state_t *cfs = state;
+    destroyRBTree(cfs->tree);
+    free(cfs);
+}
+
+static int cfs_size(void *state)
+{
+    return rbTreeSize(((cfs_state_t *)state)->tree);
+}
+
+static void cfs_push(void *state, PCB *process)
+{
+    rbTreeInsert(((cfs_state_t *)state)->tree, process->vruntime, process->id, process->slab_index);
+}
+
+// A new job starts level with the slowest runnable one instead of at 0,
+// which would let it monopolize the CPU until it caught up
+static void cfs_on_arrival(void *state, PCB *process)
+{
+    process->vruntime = ((cfs_state_t *)state)->min_vruntime;
+    cfs_push(state, process);
+}
+
+// Each CPU has its own min_vruntime, so a moved job carries its lag
+// behind the old CPU's and is placed with the same lag on the new one
+static PCB *cfs_detach(void *state)
+{
+    cfs_state_t *cfs = state;
+    PCB *process = PCB_at(rbTreePopFirst(cfs->tree));
+    if (process)
+        process->vruntime -= cfs->min_vruntime;
+    return process;
+}
+
+static void cfs_attach(void *state, PCB *process)
+{
+    process->vruntime += ((cfs_state_t *)state)->min_vruntime;
+    cfs_push(state, process);
+}
+
+static void cfs_on_tick(void *state, PCB *running, int elapsed)
+{
+    cfs_state_t *cfs = state;
+    running->vruntime += elapsed * cfs_tick_cost(running);
+    cfs->slice += elapsed;
+
+    // min_vruntime follows the smallest vruntime among runnable jobs
+    long long smallest = running->vruntime;
+    PCB *first = PCB_at(rbTreeFirst(cfs->tree));
+    if (first && first->vruntime < smallest)
+        smallest = first->vruntime;
+    if (smallest > cfs->min_vruntime)
+        cfs->min_vruntime = smallest;
+}
+
+static PCB *cfs_pick_next(void *state, PCB *running, int now)
+{
+    cfs_state_t *cfs = state;
+
+    if (running)
+    {
+        PCB *first = PCB_at(rbTreeFirst(cfs->tree));
+        if (!first || cfs->slice < cfs->granularity || first->vruntime >= running->vruntime)
+            return running;
+    }
+
+    cfs->slice = 0;
+    return PCB_at(rbTreePopFirst(cfs->tree));
+}
+
+// First tick at which the running job has had its granularity and has
+// overtaken the leftmost waiting job
+static int cfs_next_event(void *state, PCB *running, int now)
+{
+    cfs_state_t *cfs = state;
+    PCB *first = PCB_at(rbTreeFirst(cfs->tree));
+    if (!first)
+        return CLK_NEVER;
+
+    long long ticks = cfs->granularity - cfs->slice > 0 ? cfs->granularity - cfs->slice : 1;
+    long long gap = first->vruntime - running->vruntime;
+    if (gap >= 0 && gap / cfs_tick_cost(running) + 1 > ticks)
+        ticks = gap / cfs_tick_cost(running) + 1;
+    return ticks >= CLK_NEVER - now ? CLK_NEVER : now + (int)ticks;
+}
+
+const scheduler_policy_t cfs_policy = {
+    .name = "cfs",
+    .label = "CFS",
+    .configure = cfs_configure,
+    .create = cfs_create,
+    .destroy = cfs_destroy,
+    .size = cfs_size,
+    .on_arrival = cfs_on_arrival,
+    .on_tick = cfs_on_tick,
+    .pick_next = cfs_pick_next,
+    .on_preempt = cfs_push,
+    .detach = cfs_detach,
+    .attach = cfs_attach,
+    .next_event = cfs_next_event,
+};
@@ -0,0 +1,52 @@
+#include "scheduler.h"
+#include "policies/policy.h"
+#include "models/ReadyHeap/readyHeap.h"
+
+// Non-preemptive Highest Priority First: lower priority value runs first,
+// ties by arrival time, then by id
+
+#define HPF_KEY(p) READY_KEY((p)->priority, (p)->arrival_time)
+
+static void *hpf_create(const policy_options_t *options, int expected_jobs)
+{
+    printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+    printf("Scheduler started with Highest Priority First algorithm\n");
+    return createReadyHeap(expected_jobs);
+}
+
+static void hpf_destroy(void *state)
+{
+    destroyReadyHeap(state);
+}
+
+static void hpf_push(void *state, PCB *process)
+{
+    readyHeapPush(state, HPF_KEY(process), process->id, process->slab_index);
+}
+
+static PCB *hpf_detach(void *state)
+{
+    return PCB_at(readyHeapPop(state));
+}
+
+static PCB *hpf_pick_next(void *state, PCB *running, int now)
+{
+    if (running)
+        return running; // Runs to completion
+
+    return PCB_at(readyHeapPop(state));
+}
+
+const scheduler_policy_t hpf_policy = {
+    .name = "hpf",
+    .label = "HPF",
+    .configure = policy_without_options,
+    .create = hpf_create,
+    .destroy = hpf_destroy,
+    .size = readyHeapSize,
+    .on_arrival = hpf_push,
+    .pick_next = hpf_pick_next,
+    .on_preempt = hpf_push,
+    .detach = hpf_detach,
+    .attach = hpf_push,
+};
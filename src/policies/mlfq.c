@@ -0,0 +1,226 @@
+#include <limits.h>
+#include "scheduler.h"
+#include "policies/policy.h"
+#include "models/MLQueue/mlQueue.h"
+
+// Multi-Level Feedback Queue: run the head of the highest non-empty level.
+// A job that uses up its level's slice drops one level; a job on a lower
+// level is preempted as soon as a higher level has work. Every boost_period
+// ticks all jobs return to level 0.
+
+#define MLFQ_DEFAULT_LEVELS 3  // With a single -q, level i runs for quantum << i ticks
+#define MLFQ_DEFAULT_BOOST 50  // Ticks between priority boosts
+
+typedef struct {
+    MLQueue *queue;
+    int levels;
+    int quantum[ML_QUEUE_MAX_LEVELS];
+    int boost_period;
+    int next_boost;  // Tick of the next boost, always a multiple of boost_period
+    int slice;       // Ticks the running job has had on its current level
+} mlfq_state_t;
+
+// "-q 2" doubles per level (2, 4, 8, ...), "-q 1,3,9" lists one quantum per
+// level and so also sets the level count
+static int mlfq_configure(policy_options_t *options)
+{
+    if (options->quanta_count == 0)
+    {
+        printf("Error: Invalid arguments\n");
+        return -1;
+    }
+    if (options->quanta_count == 1)
+    {
+        if (options->levels == 0)
+            options->levels = MLFQ_DEFAULT_LEVELS;
+        if (options->levels > ML_QUEUE_MAX_LEVELS)
+        {
+            printf("Error: MLFQ needs 1 to %d levels\n", ML_QUEUE_MAX_LEVELS);
+            return -1;
+        }
+        long base = options->quanta[0];
+        for (int level = 0; level < options->levels; level++)
+        {
+            if (base <= 0 || (base << level) > INT_MAX)
+            {
+                printf("Error: invalid MLFQ quantum %ld for %d levels\n", base, options->levels);
+                return -1;
+            }
+            options->quanta[level] = (int)(base << level);
+        }
+        options->quanta_count = options->levels;
+    }
+    else
+    {
+        if (options->levels && options->levels != options->quanta_count)
+        {
+            printf("Error: -l %d does not match the %d quanta given\n", options->levels, options->quanta_count);
+            return -1;
+        }
+        options->levels = options->quanta_count;
+        for (int level = 0; level < options->levels; level++)
+        {
+            if (options->quanta[level] <= 0)
+            {
+                printf("Error: MLFQ quanta must be positive\n");
+                return -1;
+            }
+        }
+    }
+
+    if (options->boost_period == 0)
+        options->boost_period = MLFQ_DEFAULT_BOOST;
+    return 0;
+}
+
+static void *mlfq_create(const policy_options_t *options, int expected_jobs)
+{
+    mlfq_state_t *mlfq = calloc(1, sizeof(*mlfq));
+    if (!mlfq)
+        return NULL;
+    mlfq->queue = createMLQueue(options->levels);
+    if (!mlfq->queue)
+    {
+        free(mlfq);
+        return NULL;
+    }
+    mlfq->levels = options->levels;
+    for (int level = 0; level < options->levels; level++)
+        mlfq->quantum[level] = options->quanta[level];
+    mlfq->boost_period = options->boost_period;
+    mlfq->next_boost = options->boost_period;
+    printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+    printf("Scheduler started with Multi-Level Feedback Queue algorithm, %d levels, boost every %d ticks\n",
+           mlfq->levels, mlfq->boost_period);
+    return mlfq;
+}
+
+static void mlfq_destroy(void *state)
+{
+    mlfq_state_t *mlfq = state;
+    destroyMLQueue(mlfq->queue);
+    free(mlfq);
+}
+
+static int mlfq_size(void *state)
+{
+    return mlQueueSize(((mlfq_state_t *)state)->queue);
+}
+
+// New jobs start at the top
+static void mlfq_on_arrival(void *state, PCB *process)
+{
+    process->level = 0;
+    mlQueuePush(((mlfq_state_t *)state)->queue, 0, process);
+}
+
+// Preempted or demoted jobs go to the back of their level
+static void mlfq_on_preempt(void *state, PCB *process)
+{
+    mlQueuePush(((mlfq_state_t *)state)->queue, process->level, process);
+}
+
+// Moved jobs keep their level
+static PCB *mlfq_detach(void *state)
+{
+    return mlQueuePop(((mlfq_state_t *)state)->queue, NULL);
+}
+
+static void mlfq_on_tick(void *state, PCB *running, int elapsed)
+{
+    ((mlfq_state_t *)state)->slice += elapsed;
+}
+
+// Whether any job sits below level 0, i.e. a boost would change anything
+static int mlfq_has_demoted(mlfq_state_t *mlfq, PCB *running)
+{
+    return (mlfq->queue->nonEmpty & ~1u) || (running && running->level > 0);
+}
+
+// Move every waiting job back to level 0, upper levels first so the order
+// within each level is kept. The running job also gets a fresh slice.
+static void mlfq_boost(mlfq_state_t *mlfq, PCB *running)
+{
+    for (int level = 1; level < mlfq->levels; level++)
+    {
+        PCB *process;
+        while ((process = mlQueuePopLevel(mlfq->queue, level)) != NULL)
+        {
+            process->level = 0;
+            mlQueuePush(mlfq->queue, 0, process);
+        }
+    }
+    if (running)
+    {
+        running->level = 0;
+        mlfq->slice = 0;
+    }
+}
+
+static PCB *mlfq_pick_next(void *state, PCB *running, int now)
+{
+    mlfq_state_t *mlfq = state;
+
+    if (now >= mlfq->next_boost)
+    {
+        if (mlfq_has_demoted(mlfq, running))
+        {
+            printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+            printf("Priority boost at time %d\n", now);
+            mlfq_boost(mlfq, running);
+        }
+        mlfq->next_boost = (now / mlfq->boost_period + 1) * mlfq->boost_period;
+    }
+
+    if (running)
+    {
+        int level = running->level;
+        int highest = mlQueueHighestLevel(mlfq->queue);
+        if (mlfq->slice >= mlfq->quantum[level])
+        {
+            if (level + 1 < mlfq->levels)
+                running->level = ++level;
+            printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+            printf("Quantum expired for Process %d (remaining time: %d), now on level %d\n",
+                   running->id, running->remaining_time, level);
+            mlfq->slice = 0;
+            if (highest < 0 || highest > level)
+                return running; // Still the best candidate
+        }
+        else if (highest < 0 || highest >= level)
+        {
+            return running;
+        }
+    }
+
+    mlfq->slice = 0;
+    return mlQueuePop(mlfq->queue, NULL);
+}
+
+// Slice expiry, plus the next boost while one would move anybody. Boosts
+// are at multiples of the period, so skipping a no-op one is safe.
+static int mlfq_next_event(void *state, PCB *running, int now)
+{
+    mlfq_state_t *mlfq = state;
+    int quantum = mlfq->quantum[running->level];
+    int next = now + (quantum - mlfq->slice > 0 ? quantum - mlfq->slice : 1);
+    if (mlfq_has_demoted(mlfq, running) && mlfq->next_boost < next)
+        next = mlfq->next_boost;
+    return next;
+}
+
+const scheduler_policy_t mlfq_policy = {
+    .name = "mlfq",
+    .label = "MLFQ",
+    .configure = mlfq_configure,
+    .create = mlfq_create,
+    .destroy = mlfq_destroy,
+    .size = mlfq_size,
+    .on_arrival = mlfq_on_arrival,
+    .on_tick = mlfq_on_tick,
+    .pick_next = mlfq_pick_next,
+    .on_preempt = mlfq_on_preempt,
+    .detach = mlfq_detach,
+    .attach = mlfq_on_preempt,
+    .next_event = mlfq_next_event,
+};
@@ -0,0 +1,65 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <stdio.h>
+
+typedef struct PCB PCB;
+
+#define POLICY_MAX_QUANTA 32
+
+// Policy settings from the command line, 0 where not given
+typedef struct policy_options {
+    int quanta[POLICY_MAX_QUANTA]; // -q, a single value or a comma-separated list
+    int quanta_count;              // Values given with -q
+    int levels;                    // -l
+    int boost_period;              // -B
+} policy_options_t;
+
+// A scheduling policy owns the ready set and decides who runs. The core
+// loop only calls these hooks; hooks marked optional may be NULL.
+typedef struct scheduler_policy {
+    const char *name;   // Value of -s
+    const char *label;  // Short name for messages, e.g. "RR"
+
+    // Generator side, before forking: check the options and fill in defaults.
+    // Prints the problem and returns -1 if they do not fit the policy.
+    int (*configure)(policy_options_t *options);
+
+    // Scheduler side: build the ready set, sized for expected_jobs
+    void *(*create)(const policy_options_t *options, int expected_jobs);
+    void (*destroy)(void *state);
+    int (*size)(void *state);  // Jobs in the ready set
+
+    void (*on_arrival)(void *state, PCB *process);              // A new job is ready
+    void (*on_tick)(void *state, PCB *running, int elapsed);    // Optional: running ran for `elapsed` ticks
+
+    // Job to run at `now`, taken out of the ready set. Returning anything but
+    // `running` preempts it, and the core then hands it back via on_preempt.
+    PCB *(*pick_next)(void *state, PCB *running, int now);
+    void (*on_preempt)(void *state, PCB *process);              // Optional: NULL if pick_next already put it back
+    void (*on_finish)(void *state, PCB *process);               // Optional: running finished
+
+    // Multi-CPU: take a waiting job out to move it to another CPU's ready
+    // set (NULL if none), and take in a job moved from another CPU
+    PCB *(*detach)(void *state);
+    void (*attach)(void *state, PCB *process);
+
+    // Optional: earliest tick the policy must see with `running` on the CPU
+    // (quantum expiry, boost, ...), CLK_NEVER if none. Used by fast-forward.
+    int (*next_event)(void *state, PCB *running, int now);
+} scheduler_policy_t;
+
+// Registry
+const scheduler_policy_t *find_policy(const char *name);
+void print_policies(FILE *out);
+
+// configure() for policies that take no -q, -l or -B
+int policy_without_options(policy_options_t *options);
+
+extern const scheduler_policy_t hpf_policy;
+extern const scheduler_policy_t srtn_policy;
+extern const scheduler_policy_t rr_policy;
+extern const scheduler_policy_t mlfq_policy;
+extern const scheduler_policy_t cfs_policy;
+
+#endif /* POLICY_H */
@@ -0,0 +1,41 @@
+#include <string.h>
+#include "policies/policy.h"
+
+// Every policy -s can name. A new policy only needs an entry here.
+static const scheduler_policy_t *const policies[] = {
+    &hpf_policy,
+    &srtn_policy,
+    &rr_policy,
+    &mlfq_policy,
+    &cfs_policy,
+};
+
+#define POLICY_COUNT (int)(sizeof(policies) / sizeof(policies[0]))
+
+// Policy registered under `name`, NULL if none
+const scheduler_policy_t *find_policy(const char *name)
+{
+    for (int i = 0; i < POLICY_COUNT; i++)
+    {
+        if (strcmp(policies[i]->name, name) == 0)
+            return policies[i];
+    }
+    return NULL;
+}
+
+void print_policies(FILE *out)
+{
+    for (int i = 0; i < POLICY_COUNT; i++)
+        fprintf(out, "%s%s", i ? ", " : "", policies[i]->name);
+    fprintf(out, "\n");
+}
+
+int policy_without_options(policy_options_t *options)
+{
+    if (options->quanta_count || options->levels || options->boost_period)
+    {
+        printf("Error: Invalid arguments\n");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "scheduler.h"
+#include "policies/policy.h"
+#include "models/Queue/queue.h"
+
+// Round Robin: FIFO ready queue, the running job goes to the back once it
+// has used `quantum` ticks and someone else is waiting
+
+typedef struct {
+    Queue *queue;
+    int quantum;
+    int slice;    // Ticks the running job has had since it was dispatched
+} rr_state_t;
+
+static int rr_configure(policy_options_t *options)
+{
+    if (options->quanta_count != 1 || options->levels || options->boost_period)
+    {
+        printf("Error: Invalid arguments\n");
+        return -1;
+    }
+    if (options->quanta[0] <= 0)
+    {
+        printf("Error: RR quantum must be positive\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void *rr_create(const policy_options_t *options, int expected_jobs)
+{
+    rr_state_t *rr = malloc(sizeof(*rr));
+    if (!rr)
+        return NULL;
+    rr->queue = createQueue();
+    if (!rr->queue)
+    {
+        free(rr);
+        return NULL;
+    }
+    rr->quantum = options->quanta[0];
+    rr->slice = 0;
+    printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+    printf("Scheduler started with Round Robin algorithm, quantum = %d\n", rr->quantum);
+    return rr;
+}
+
+static void rr_destroy(void *state)
+{
+    rr_state_t *rr = state;
+    destroyQueue(rr->queue);
+    free(rr);
+}
+
+static int rr_size(void *state)
+{
+    return getSize(((rr_state_t *)state)->queue);
+}
+
+static void rr_push(void *state, PCB *process)
+{
+    enqueue(((rr_state_t *)state)->queue, process);
+}
+
+static PCB *rr_detach(void *state)
+{
+    rr_state_t *rr = state;
+    return isEmpty(rr->queue) ? NULL : (PCB *)dequeue(rr->queue);
+}
+
+static void rr_on_tick(void *state, PCB *running, int elapsed)
+{
+    ((rr_state_t *)state)->slice += elapsed;
+}
+
+static PCB *rr_pick_next(void *state, PCB *running, int now)
+{
+    rr_state_t *rr = state;
+
+    if (running)
+    {
+        if (rr->slice < rr->quantum)
+            return running;
+
+        printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+        printf("Quantum expired for Process %d (remaining time: %d)\n", running->id, running->remaining_time);
+        rr->slice = 0;
+        if (isEmpty(rr->queue))
+            return running; // Nobody else waiting, keep going
+    }
+
+    rr->slice = 0;
+    return isEmpty(rr->queue) ? NULL : (PCB *)dequeue(rr->queue);
+}
+
+static int rr_next_event(void *state, PCB *running, int now)
+{
+    rr_state_t *rr = state;
+    int slice_left = rr->quantum - rr->slice > 0 ? rr->quantum - rr->slice : 1;
+    return now + slice_left;
+}
+
+const scheduler_policy_t rr_policy = {
+    .name = "rr",
+    .label = "RR",
+    .configure = rr_configure,
+    .create = rr_create,
+    .destroy = rr_destroy,
+    .size = rr_size,
+    .on_arrival = rr_push,
+    .on_tick = rr_on_tick,
+    .pick_next = rr_pick_next,
+    .on_preempt = rr_push,
+    .detach = rr_detach,
+    .attach = rr_push,
+    .next_event = rr_next_event,
+};
@@ -0,0 +1,57 @@
+#include "scheduler.h"
+#include "policies/policy.h"
+#include "models/ReadyHeap/readyHeap.h"
+
+// Shortest Remaining Time Next: the job with the least work left runs and
+// preempts the running one when it has strictly less. Ties by arrival
+// time, then by id.
+
+#define SRTN_KEY(p) READY_KEY((p)->remaining_time, (p)->arrival_time)
+
+static void *srtn_create(const policy_options_t *options, int expected_jobs)
+{
+    printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+    printf("Scheduler started with Shortest Remaining Time Next algorithm\n");
+    return createReadyHeap(expected_jobs);
+}
+
+static void srtn_destroy(void *state)
+{
+    destroyReadyHeap(state);
+}
+
+// Keyed on the remaining time at the moment it (re)enters the ready set
+static void srtn_push(void *state, PCB *process)
+{
+    readyHeapPush(state, SRTN_KEY(process), process->id, process->slab_index);
+}
+
+static PCB *srtn_detach(void *state)
+{
+    return PCB_at(readyHeapPop(state));
+}
+
+// A preempted job goes back in the same sift that takes the new one out
+static PCB *srtn_pick_next(void *state, PCB *running, int now)
+{
+    if (!running)
+        return PCB_at(readyHeapPop(state));
+
+    PCB *top = PCB_at(readyHeapPeek(state));
+    if (!top || top->remaining_time >= running->remaining_time)
+        return running;
+    return PCB_at(readyHeapReplaceTop(state, SRTN_KEY(running), running->id, running->slab_index));
+}
+
+const scheduler_policy_t srtn_policy = {
+    .name = "srtn",
+    .label = "SRTN",
+    .configure = policy_without_options,
+    .create = srtn_create,
+    .destroy = srtn_destroy,
+    .size = readyHeapSize,
+    .on_arrival = srtn_push,
+    .pick_next = srtn_pick_next,
+    .detach = srtn_detach,
+    .attach = srtn_push,
+};
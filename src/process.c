@@ -1,4 +1,6 @@
 #include "clk.h"
+#include "futex.h"
+#include "process.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -9,12 +11,14 @@ int remaining_time = 0; // Placeholder for remaining time
 
 
 // Function to simulate the process execution
-void run_process(int runtime, int id, int *current_shm_ptr)
+void run_process(int runtime, int id, ProcessSlot *slot)
 {
-    // Process terminates when the shared memory value reaches 0
+    // Process terminates when the remaining time in its slot reaches 0. Sleep
+    // until the scheduler wakes us for that instead of spinning on it.
     while (remaining_time > 0)
     {
-        remaining_time = *current_shm_ptr; // Get the remaining time from shared memory
+        futex_wait(&slot->remaining_time, remaining_time);
+        remaining_time = __atomic_load_n(&slot->remaining_time, __ATOMIC_SEQ_CST); // Get the remaining time from the slot
     }
 }
 
@@ -23,28 +27,29 @@ int main(int argc, char *argv[])
     sync_clk(); // Establish communication with the clock module
 
     // Validate the number of arguments
-    if (argc != 4)
+    if (argc != 5)
     {
-        printf("Usage: %s <runtime>\n", argv[0]);
+        printf("Usage: %s <runtime> <id> <slots shm id> <slot>\n", argv[0]);
         return 1;
     }
 
     // Parse command-line arguments
     int runtime = atoi(argv[1]); // Runtime of the process
     int id = atoi(argv[2]);      // Process ID
-    int shm_id = atoi(argv[3]);  // Shared memory ID
+    int shm_id = atoi(argv[3]);  // Shared slot array ID
+    int slot = atoi(argv[4]);    // This process's slot in it
 
-    // Attach to the shared memory segment
+    // Attach to the shared slot array
 
-    int *current_shm_ptr = (int *)shmat(shm_id, NULL, 0);
-    if ((long)current_shm_ptr == -1)
+    ProcessSlot *slots = (ProcessSlot *)shmat(shm_id, NULL, 0);
+    if ((long)slots == -1)
     {
         perror("Failed to attach shared memory segment1");
         return 1;
     }
 
 
-    remaining_time = *current_shm_ptr; // Get the initial remaining time from shared memory
+    remaining_time = slots[slot].remaining_time; // Get the initial remaining time from the slot
 
     if (runtime < 0)
     {
@@ -54,11 +59,11 @@ int main(int argc, char *argv[])
 
 
     // Run the process simulation
-    run_process(runtime, id, current_shm_ptr);
+    run_process(runtime, id, &slots[slot]);
 
     // Detach from the shared memory segment
 
-    if (shmdt(current_shm_ptr) == -1)
+    if (shmdt(slots) == -1)
     {
         perror("Failed to Deattach shared memory segment");
         return 1;
@@ -1,17 +1,32 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#define SLOT_CACHE_LINE 64
+
+/**
+ * @brief Control block shared between the scheduler and one forked process.
+ *
+ * The generator creates a single array of slots for the whole run and each
+ * job owns the slot at its index in the input file. A slot fills its own
+ * cache line so updates to one job never touch another job's line.
+ */
+typedef struct {
+    volatile int remaining_time; // Written by the scheduler, the process sleeps on it
+    volatile int state;          // The scheduler's READY, RUNNING or FINISHED
+    volatile unsigned int seq;   // Bumped after every update
+} __attribute__((aligned(SLOT_CACHE_LINE))) ProcessSlot;
+
 /**
  * @brief Executes a process for a specified runtime.
  * 
  * This function simulates the execution of a process by running it
- * for a given amount of time. It also interacts with shared memory
- * to update or retrieve process-related data.
+ * for a given amount of time. It sleeps on its control slot until the
+ * scheduler brings the remaining time down to zero.
  * 
  * @param runtime The duration (in arbitrary time units) for which the process should run.
  * @param id The unique identifier of the process to be executed.
- * @param current_shm_ptr Pointer to the shared memory segment used for inter-process communication.
+ * @param slot The process's control slot in the shared slot array.
  */
-void run_process(int runtime, int id, int *current_shm_ptr);
+void run_process(int runtime, int id, ProcessSlot *slot);
 
-#endif
\ No newline at end of file
+#endif
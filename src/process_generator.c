@@ -2,17 +2,23 @@
 
 
 int processCount = 0;
-FILE* memoryLogFile; // File pointer for memory log
+event_log_t* memoryLogFile = NULL; // memory.log, written in batches
 
-int arrG_msgq_id = -1; // Message queue ID for arrival messages
-int compG_msgq_id = -1; // Message queue ID for completion messages
+SchedulerChannels channelsG; // Rings to and from the scheduler
+int slots_shm_id = -1;       // Per-job control slots of forked processes
 
 pid_t scheduler_pid = -1;
+int execution_backend = BACKEND_FORK; // How simulated processes are executed
 
-process_data* waiting_list_HEAD;
-process_data* waiting_list_TAIL;
+// Processes blocked on memory, one FIFO per buddy order they need
+process_data* waiting_list_HEAD[WAITING_ORDERS];
+process_data* waiting_list_TAIL[WAITING_ORDERS];
+int waiting_count = 0;
+int memory_freed = 0; // A free happened since the waiting list was last retried
 
-memory_block_t *memory_root = NULL;
+buddy_allocator_t *memory_root = NULL;
+HashMap *process_by_pid = NULL; // pid -> process_data, read from the SIGCHLD handler
+sigset_t sigchld_set;
 
 // Signal handler for SIGCHLD to handle terminated child processes
 void sigchld_handler(int sig)
@@ -23,7 +29,7 @@ void sigchld_handler(int sig)
 
     while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
     {
-        if (WIFEXITED(status))
+        if (WIFEXITED(status) && execution_backend == BACKEND_FORK)
         {
             notifySchedulerFinishedProcess(pid);
         }
@@ -33,21 +39,29 @@ void sigchld_handler(int sig)
 }
 
 
-process_data process_list[MAX_PROCESSES];
+process_data *process_list = NULL; // One block sized from the input file
 
 int main(int argc, char *argv[])
 {
-    memory_root = create_memory();
     signals_handling();
 
-    memoryLogFile = fopen("memory.log", "w");
-        if (memoryLogFile == NULL)
-        {
-            perror("Error opening memory log file");
-            exit(1);
-        }
-    fprintf(memoryLogFile, "#At time x allocated y bytes for process z from i to j\n");
-    fflush(memoryLogFile);
+    // Parse command-line arguments before forking anything so every
+    // component inherits the same simulation mode
+    const scheduler_policy_t *policy = NULL;
+    policy_options_t policy_options = {{0}};
+    int cpu_count = 1;
+    int processCount = 0;
+    memory_config_t memory_config = {DEFAULT_MEMORY_SIZE, DEFAULT_MIN_BLOCK_SIZE, 0};
+    arguments_Reader(argc, argv, &policy, &policy_options, &cpu_count, &execution_backend, &processCount, &process_list, &memory_config);
+
+    if (processCount <= 0)
+    {
+        printf("No processes to generate\n");
+        exit(1);
+    }
+    process_by_pid = createHashMap(processCount);
+    memory_root = create_memory(&memory_config);
+    fflush(stdout); // Don't let the children inherit and repeat buffered output
 
     pid_t clk_pid = fork();
 
@@ -66,35 +80,26 @@ int main(int argc, char *argv[])
     }
     else // Parent process (generator)
     {
-        // Create message queues for communication with the scheduler
-        key_t arr_key = ftok("keyfile", 'a');
-        arrG_msgq_id = msgget(arr_key, 0666 | IPC_CREAT);
-        if (arrG_msgq_id == -1)
+        // Create the rings to the scheduler. Every job crosses each of them
+        // at most once, plus the end-of-arrivals record.
+        channelsG.arrivals = createShmRing(sizeof(ArrivalRecord), processCount + 1);
+        channelsG.exits = createShmRing(sizeof(CompletionRecord), processCount);
+        channelsG.finished = createShmRing(sizeof(CompletionRecord), processCount);
+        if (!channelsG.arrivals || !channelsG.exits || !channelsG.finished)
         {
-            perror("Error creating arrival message queue");
             exit(1);
         }
-
-        key_t comp_key = ftok("keyfile", 'c');
-        compG_msgq_id = msgget(comp_key, 0666 | IPC_CREAT);
-        if (compG_msgq_id == -1)
+        // Watching is optional: run without the page if it cannot be had
+        channelsG.stats = stats_page_create();
+        if (execution_backend == BACKEND_FORK)
         {
-            perror("Error creating completion message queue");
-            exit(1);
+            channelsG.slots = create_process_slots(processCount);
+            if (!channelsG.slots)
+            {
+                exit(1);
+            }
         }
 
-        // Parse command-line arguments to determine scheduling algorithm and input file
-        int algoritm_type = 0;   // 1: HPF, 2: SRTN, 3: RR
-        int quantum = 1;         // Default quantum for RR
-        int processCount = 0;
-        arguments_Reader(argc, argv, &algoritm_type, &quantum, &processCount, process_list);
-
-        if (processCount == 0)
-        {
-            printf("No processes to generate\n");
-            exit(1);
-        }
-        
         // Fork and execute the scheduler
         scheduler_pid = fork();
         if (scheduler_pid == -1)
@@ -106,58 +111,73 @@ int main(int argc, char *argv[])
         if (scheduler_pid == 0)
         {
             // Scheduler process
-            initialize(algoritm_type, quantum);
+            initialize(policy, &policy_options, execution_backend, cpu_count, processCount, &channelsG);
             run_scheduler();
             cleanup();
             exit(0);
         }
 
+        // The log runs a writer thread, so open it only once the clock and
+        // the scheduler are forked
+        memoryLogFile = event_log_open("memory.log", EVENT_LOG_MEMORY);
+        if (memoryLogFile == NULL)
+        {
+            perror("Error opening memory log file");
+            clear_resources(0);
+        }
+
         sync_clk();
         
         int next_process_idx = 0;
         int current_time = -1;
 
-        waiting_list_HEAD = NULL;
-        waiting_list_TAIL = NULL;
-
-        while (get_clk() < 0)
-        {
-        }
         // Main loop - send a message on every clock tick
         while (1)
         {
-            int new_time = get_clk();
+            // Sleep until the clock publishes the next tick
+            current_time = wait_next_tick(current_time);
+
+            printf("\033[1;31m");
+            printf("[Process Generator] ");
+            printf("\033[0m");
+            printf("Generator tick at time %d\n", current_time);
 
-            if (new_time > current_time)
+            // Memory freed by this tick's completions must be visible
+            // before the waiting list is retried
+            wait_stage(STAGE_COMPLETIONS, current_time);
+            receive_finished_jobs();
+
+            if (check_no_more_processes(next_process_idx, processCount, current_time))
             {
-                current_time = new_time;
-                printf("\033[1;31m");
-                printf("[Process Generator] ");
-                printf("\033[0m");
-                printf("Generator tick at time %d\n", current_time);
+                retire_stage(STAGE_ARRIVALS);
+                break;
+            }
 
-                int processes_sent = 0; // Track if any processes were sent
+            // The SIGCHLD handler reads process_by_pid: hold it off while
+            // this tick adds to it. Completions are reaped while we sleep
+            // between ticks.
+            sigprocmask(SIG_BLOCK, &sigchld_set, NULL);
 
-                if (check_no_more_processes(next_process_idx, processCount))
-                {
-                    break;
-                }
+            sending_waiting_proccess(current_time);
 
-                usleep(20000);
+            sending_arrival_processes(&next_process_idx, processCount, current_time);
 
-                sending_waiting_proccess(current_time, &processes_sent);
+            // The whole tick reaches the scheduler in one store
+            shmRingPublish(channelsG.arrivals);
 
-                sending_arrival_processes(&next_process_idx, processCount, current_time, &processes_sent);
+            publish_generator_stats(next_process_idx, processCount, current_time);
 
-                there_is_no_processes(processes_sent);
+            sigprocmask(SIG_UNBLOCK, &sigchld_set, NULL);
 
-            }
-            usleep(1000); // Sleep for 1ms
+            finish_stage(STAGE_ARRIVALS, current_time,
+                         next_generator_event(next_process_idx, processCount, current_time));
         }
 
         // Wait for the scheduler to finish
         int status;
         waitpid(scheduler_pid, &status, 0);
+        receive_finished_jobs(); // Jobs that finished after the last arrival
+        publish_generator_stats(next_process_idx, processCount, get_clk());
 
         clear_resources(0); // Clean up resources
     }
@@ -170,6 +190,8 @@ int main(int argc, char *argv[])
 void signals_handling()
 {
     signal(SIGINT, clear_resources);
+    sigemptyset(&sigchld_set);
+    sigaddset(&sigchld_set, SIGCHLD);
     struct sigaction sa;
     sa.sa_handler = sigchld_handler;
     sigemptyset(&sa.sa_mask);
@@ -183,73 +205,183 @@ void signals_handling()
 }
 
 
-void arguments_Reader(int argc, char *argv[], int *algorithm_type, int *quantum, int *processCount, process_data process_list[])
+void arguments_Reader(int argc, char *argv[], const scheduler_policy_t **policy, policy_options_t *policy_options, int *cpu_count, int *backend, int *processCount, process_data **process_list, memory_config_t *memory_config)
 {
-    if (argc != 7 && argc != 5)
-    {
-        printf("Invalid number of arguments\n");
-        exit(1);
-    }
-    if (strcmp(argv[1], "-s") != 0)
-    {
-        printf("please enter -s before the algorithm\n");
-        exit(1);
-    }
+    char *algorithm = NULL;
+    char *filename = NULL;
 
-    char *algorithm = argv[2];
-
-    if (strcmp(algorithm, "rr") == 0 && argc == 7 && strcmp(argv[3], "-q") == 0)
+    for (int i = 1; i < argc; i++)
     {
-        *quantum = atoi(argv[4]); // Dereference the pointer to update the value in main
-        *algorithm_type = 3;      // RR
-        if (strcmp(argv[5], "-f") == 0)
+        if (strcmp(argv[i], "-ff") == 0 || strcmp(argv[i], "--fast-forward") == 0)
         {
-            *processCount = read_processes(argv[6], process_list); // Dereference the pointer
-            display_processes(process_list, *processCount);
+            set_fast_forward(1);
+            continue;
         }
-        else
+        if (strcmp(argv[i], "-T") == 0 || strcmp(argv[i], "--latency") == 0)
         {
-            printf("Error: Invalid arguments\n");
+            set_latency_tracing(1);
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            printf("Error: missing value after %s\n", argv[i]);
             exit(1);
         }
-    }
-    else if (strcmp(algorithm, "srtn") == 0 && argc == 5)
-    {
-        *algorithm_type = 2;
-        if (strcmp(argv[3], "-f") == 0)
+        if (strcmp(argv[i], "-s") == 0)
         {
-            *processCount = read_processes(argv[4], process_list); // Dereference the pointer
-            display_processes(process_list, *processCount);
+            algorithm = argv[++i];
         }
-        else
+        else if (strcmp(argv[i], "-q") == 0)
         {
-            printf("please enter -f before file name\n");
-            exit(1);
+            if (parse_quanta(argv[++i], policy_options) == -1)
+            {
+                printf("Error: invalid quantum %s (e.g. 2 or 1,2,4)\n", argv[i]);
+                exit(1);
+            }
         }
-    }
-    else if (strcmp(algorithm, "hpf") == 0 && argc == 5)
-    {
-        *algorithm_type = 1; // HPF
-        if (strcmp(argv[3], "-f") == 0)
+        else if (strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "-B") == 0)
+        {
+            int value = atoi(argv[i + 1]);
+            if (value <= 0)
+            {
+                printf("Error: invalid value %s after %s\n", argv[i + 1], argv[i]);
+                exit(1);
+            }
+            if (argv[i][1] == 'l')
+                policy_options->levels = value;
+            else
+                policy_options->boost_period = value;
+            i++;
+        }
+        else if (strcmp(argv[i], "-f") == 0)
+        {
+            filename = argv[++i];
+        }
+        else if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "-r") == 0)
+        {
+            long size = parseMemorySize(argv[i + 1]);
+            if (size <= 0)
+            {
+                printf("Error: invalid size %s after %s (e.g. 1024, 4K, 16M, 1G)\n", argv[i + 1], argv[i]);
+                exit(1);
+            }
+            if (argv[i][1] == 'm')
+                memory_config->totalSize = size;
+            else if (argv[i][1] == 'b')
+                memory_config->minBlockSize = size;
+            else
+                memory_config->maxRequestSize = size;
+            i++;
+        }
+        else if (strcmp(argv[i], "-c") == 0)
         {
-            *processCount = read_processes(argv[4], process_list); // Dereference the pointer
-            display_processes(process_list, *processCount);
+            *cpu_count = atoi(argv[++i]);
+            if (*cpu_count < 1 || *cpu_count > MAX_CPUS)
+            {
+                printf("Error: -c takes 1 to %d CPUs\n", MAX_CPUS);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "-S") == 0)
+        {
+            int ticks = atoi(argv[++i]);
+            if (ticks <= 0)
+            {
+                printf("Error: invalid stats interval %s\n", argv[i]);
+                exit(1);
+            }
+            set_stats_interval(ticks);
+        }
+        else if (strcmp(argv[i], "-e") == 0)
+        {
+            i++;
+            if (strcmp(argv[i], "fork") == 0)
+            {
+                *backend = BACKEND_FORK;
+            }
+            else if (strcmp(argv[i], "inproc") == 0)
+            {
+                *backend = BACKEND_INPROC;
+            }
+            else
+            {
+                printf("Error: unknown backend %s (use fork or inproc)\n", argv[i]);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "-L") == 0)
+        {
+            i++;
+            if (strcmp(argv[i], "text") == 0 || strcmp(argv[i], "binary") == 0)
+            {
+                set_binary_logs(argv[i][0] == 'b');
+            }
+            else
+            {
+                printf("Error: unknown log format %s (use text or binary)\n", argv[i]);
+                exit(1);
+            }
         }
         else
         {
-            printf("please enter -f before file name\n");
+            printf("Error: Invalid arguments\n");
             exit(1);
         }
     }
-    else
+
+    if (algorithm == NULL)
+    {
+        printf("please enter -s before the algorithm\n");
+        exit(1);
+    }
+    if (filename == NULL)
     {
-        printf("Error: Invalid arguments\n");
+        printf("please enter -f before file name\n");
         exit(1);
     }
+
+    *policy = find_policy(algorithm);
+    if (*policy == NULL)
+    {
+        printf("Error: unknown algorithm %s, available: ", algorithm);
+        print_policies(stdout);
+        exit(1);
+    }
+    if ((*policy)->configure(policy_options) == -1)
+    {
+        exit(1);
+    }
+
+    if (validateMemoryConfig(memory_config) == -1)
+    {
+        exit(1);
+    }
+
+    *processCount = read_processes(filename, process_list); // Dereference the pointer
+    *processCount = drop_unfittable_processes(*process_list, *processCount, memory_config->maxRequestSize);
+    display_processes(*process_list, *processCount);
 }
 
 
-int read_processes(const char *filename, process_data process_list[])
+// -q takes one quantum or a comma-separated list of them
+int parse_quanta(const char *text, policy_options_t *policy_options)
+{
+    const char *p = text;
+    char *end;
+    policy_options->quanta_count = 0;
+    do
+    {
+        long value = strtol(p, &end, 10);
+        if (end == p || value < INT_MIN || value > INT_MAX || policy_options->quanta_count == POLICY_MAX_QUANTA || (*end != ',' && *end != '\0'))
+            return -1;
+        policy_options->quanta[policy_options->quanta_count++] = (int)value;
+        p = end + 1;
+    } while (*end == ',');
+    return 0;
+}
+
+// Count the job lines first so the whole list is one allocation, then parse
+int read_processes(const char *filename, process_data **process_list)
 {
     FILE *file = fopen(filename, "r");
     if (file == NULL)
@@ -259,10 +391,27 @@ int read_processes(const char *filename, process_data process_list[])
     }
 
     char line[MAX_LINE_LENGTH];
+    int capacity = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (line[0] != '#')
+            capacity++;
+    }
+
+    *process_list = calloc(capacity > 0 ? capacity : 1, sizeof(process_data));
+    if (*process_list == NULL)
+    {
+        perror("Error allocating the process list");
+        fclose(file);
+        return -1;
+    }
+    rewind(file);
+
+    process_data *list = *process_list;
     int process_count = 0;
 
     // Skip lines starting with '#'
-    while (fgets(line, sizeof(line), file))
+    while (process_count < capacity && fgets(line, sizeof(line), file))
     {
         // Skip comment lines
         if (line[0] == '#')
@@ -272,24 +421,15 @@ int read_processes(const char *filename, process_data process_list[])
 
         // Parse the process information
         if (sscanf(line, "%d\t%d\t%d\t%d\t%d",
-                   &process_list[process_count].id,
-                   &process_list[process_count].arrival_time,
-                   &process_list[process_count].runtime,
-                   &process_list[process_count].priority,
-                   &process_list[process_count].memory_size) == 5)
+                   &list[process_count].id,
+                   &list[process_count].arrival_time,
+                   &list[process_count].runtime,
+                   &list[process_count].priority,
+                   &list[process_count].memory_size) == 5)
         {
-            process_list[process_count].pid = 0;
-            
+            list[process_count].pid = 0;
+
             process_count++;
-            
-            if (process_count >= MAX_PROCESSES)
-            {
-                printf("\033[1;31m");
-                printf("[Process Generator] ");
-                printf("\033[0m");
-                printf("Warning: Maximum process limit (%d) reached. Ignoring remaining processes.\n", MAX_PROCESSES);
-                break;
-            }
         }
     }
     fclose(file);
@@ -298,6 +438,27 @@ int read_processes(const char *filename, process_data process_list[])
 
 
 
+// Remove jobs that ask for more than a single allocation may have: they
+// could never leave the waiting list. Returns the new count.
+int drop_unfittable_processes(process_data process_list[], int count, long max_request)
+{
+    int kept = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (process_list[i].memory_size > max_request)
+        {
+            printf("\033[1;31m");
+            printf("[Process Generator] ");
+            printf("\033[0m");
+            printf("Warning: process %d needs %d bytes, more than the %ld allowed. Ignoring it.\n",
+                   process_list[i].id, process_list[i].memory_size, max_request);
+            continue;
+        }
+        process_list[kept++] = process_list[i];
+    }
+    return kept;
+}
+
 // Function to display the list of processes
 void display_processes(process_data process_list[], int count)
 {
@@ -321,79 +482,81 @@ void display_processes(process_data process_list[], int count)
 }
 
 
-int check_no_more_processes(int next_process_idx, int processCount)
+int check_no_more_processes(int next_process_idx, int processCount, int current_time)
 {
-    ProcessMessage msg;
-    msg.mtype = 1; // Any positive number
-
-    if (next_process_idx >= processCount && waiting_list_HEAD == NULL)
+    if (next_process_idx >= processCount && waiting_count == 0)
     {
         // All processes have been sent, signal completion
-        msg.process_id = -2; // Termination signal
-        msg.arrival_time = 0;
-        msg.runtime = 0;
-        msg.priority = 0;
-
         printf("\033[1;31m");
         printf("[Process Generator] ");
         printf("\033[0m");
         printf("All processes sent, sending termination signal\n");
 
-        if (msgsnd(arrG_msgq_id, &msg, sizeof(msg) - sizeof(long), 0) == -1)
-        {
-            perror("Error sending termination message");
-        }
+        ArrivalRecord done = {0};
+        done.process_id = ARRIVALS_DONE;
+        shmRingPush(channelsG.arrivals, &done);
+        shmRingPublish(channelsG.arrivals);
         return 1;
     }
     return 0;
 }
 
-void sending_waiting_proccess (int current_time, int *processes_send){
-    process_data* currentP = waiting_list_HEAD;
-    while (currentP != NULL)
+// Memory only becomes available through frees, so the waiting list is only
+// retried after one, and then only for processes whose order now fits
+void sending_waiting_proccess (int current_time){
+    if (!memory_freed || waiting_count == 0)
     {
-        printf("Sending waiting processes at time %d\n", current_time);
-        memory_block_t* memory = allocateMemory(memory_root, currentP->memory_size);
-        if(memory == NULL)
-        {
-            printf("cannot allocate memory for process %d\n", currentP->id);
-            fancyPrintTree(memory_root, 0);
-            currentP=currentP->next;
-            continue;
-        }
-        else
+        return;
+    }
+    memory_freed = 0;
+
+    process_data* currentP;
+    while ((currentP = waiting_list_next_fitting()) != NULL)
+    {
+        currentP->memory = allocateMemory(memory_root, currentP->memory_size);
+        if (!MEMORY_HANDLE_VALID(currentP->memory))
         {
-            printf("allocated memory for process %d\n", currentP->id);
+            break; // Cannot happen: its order fits
         }
+        printf("allocated memory for process %d\n", currentP->id);
 
-        log_memory_stats(currentP, "allocated", current_time, memory->start, memory->end);
+        log_memory_stats(currentP, EVENT_ALLOCATED, current_time, currentP->memory.start, MEMORY_HANDLE_END(currentP->memory));
         waiting_list_remove(currentP);
-        *processes_send += sending_process(currentP, current_time);
-        memory->processId = currentP->pid;
-        currentP=currentP->next;
+        sending_process(currentP, current_time);
+        setMemoryOwner(memory_root, currentP->memory, currentP->pid);
     }
 
 }
 
-int sending_process(process_data * process, int current_time){
-    ProcessMessage msg;
-    // Create shared memory for this process
-    int shm_id = shmget(IPC_PRIVATE, sizeof(int), 0666 | IPC_CREAT);
-    if (shm_id == -1)
+// One control slot per job for the whole run, in a single segment the
+// scheduler inherits and every `process` child attaches by id
+ProcessSlot* create_process_slots(int count)
+{
+    slots_shm_id = shmget(IPC_PRIVATE, sizeof(ProcessSlot) * count, 0666 | IPC_CREAT);
+    if (slots_shm_id == -1)
     {
-        perror("Failed to create shared memory");
-        return 0;
+        perror("Failed to create the process slots");
+        return NULL;
     }
-
-    int *shm_ptr = (int *)shmat(shm_id, NULL, 0);
-    if (shm_ptr == (void *)-1)
+    ProcessSlot *slots = (ProcessSlot *)shmat(slots_shm_id, NULL, 0);
+    if (slots == (void *)-1)
     {
-        perror("Failed to attach shared memory");
-        shmctl(shm_id, IPC_RMID, NULL); // Clean up shared memory
-        return 0;
+        perror("Failed to attach the process slots");
+        shmctl(slots_shm_id, IPC_RMID, NULL);
+        slots_shm_id = -1;
+        return NULL;
     }
+    return slots;
+}
 
-    *shm_ptr = process->runtime; // Initialize shared memory with runtime
+// Fork a stopped `process` child for the job in `slot` and give it the
+// job's runtime there. Returns the child's pid, or -1 on failure.
+pid_t spawn_process(process_data * process, int slot)
+{
+    ProcessSlot *control = &channelsG.slots[slot];
+    control->remaining_time = process->runtime;
+    control->state = READY;
+    control->seq = 0;
 
     // Fork the process
     pid_t process_pid = fork();
@@ -401,191 +564,262 @@ int sending_process(process_data * process, int current_time){
     if (process_pid == -1)
     {
         perror("Failed to fork process");
-        shmdt(shm_ptr);
-        shmctl(shm_id, IPC_RMID, NULL);
-        return 0;
+        return -1;
     }
 
     if (process_pid == 0)
     { // Child process
-        char runtime_str[20], id_str[20], shm_id_str[20];
+        char runtime_str[20], id_str[20], shm_id_str[20], slot_str[20];
         sprintf(runtime_str, "%d", process->runtime);
         sprintf(id_str, "%d", process->id);
-        sprintf(shm_id_str, "%d", shm_id);
+        sprintf(shm_id_str, "%d", slots_shm_id);
+        sprintf(slot_str, "%d", slot);
 
-        execl("process", "process", runtime_str, id_str, shm_id_str, NULL);
+        // Stop before exec: a SIGSTOP sent by the parent can lose the race
+        // against exec, and a zero-runtime job would then exit unscheduled
+        raise(SIGSTOP);
+        execl("process", "process", runtime_str, id_str, shm_id_str, slot_str, NULL);
 
         perror("Failed to execute process");
         exit(1);
     }
 
-    kill(process_pid, SIGSTOP);
-    process->pid = process_pid;
+    // The scheduler's first SIGCONT must not overtake the stop
+    int status;
+    waitpid(process_pid, &status, WUNTRACED);
+    return process_pid;
+}
 
-    msg.process_id = process->id;
-    msg.arrival_time = process->arrival_time;
-    msg.runtime = process->runtime;
-    msg.priority = process->priority;
-    msg.pid = process_pid;
-    msg.shm_id = shm_id;
-    msg.mtype = 1; // Any positive number
+int sending_process(process_data * process, int current_time){
+    int slot = process - process_list;
+    pid_t process_pid;
 
-    printf("\033[1;31m");
-    printf("[Process Generator] ");
-    printf("\033[0m");
-    printf("Forked and sending process %d to scheduler at time %d\n",
-           msg.process_id, current_time);
+    if (execution_backend == BACKEND_INPROC)
+    {
+        // No child at all: the job lives only as a PCB in the scheduler and is
+        // known by its slot in process_list
+        process_pid = (pid_t)slot + 1;
+    }
+    else
+    {
+        process_pid = spawn_process(process, slot);
+        if (process_pid == -1)
+        {
+            return 0;
+        }
+    }
 
-    if (msgsnd(arrG_msgq_id, &msg, sizeof(msg) - sizeof(long), 0) == -1)
+    process->pid = process_pid;
+    hashMapPut(process_by_pid, process_pid, process);
+
+    ArrivalRecord rec;
+    rec.process_id = process->id;
+    rec.arrival_time = process->arrival_time;
+    rec.runtime = process->runtime;
+    rec.priority = process->priority;
+    rec.pid = process_pid;
+    rec.slot = slot;
+    if (!shmRingPush(channelsG.arrivals, &rec))
     {
-        perror("Error sending process message");
+        printf("Error: arrival ring is full\n");
     }
 
-    shmdt(shm_ptr);
+    printf("\033[1;31m");
+    printf("[Process Generator] ");
+    printf("\033[0m");
+    printf("%s and queued process %d for the scheduler at time %d\n",
+           execution_backend == BACKEND_FORK ? "Forked" : "Created", rec.process_id, current_time);
+
     return 1;
 }
 
 void print_waiting_list()
 {
-    process_data* current = waiting_list_HEAD;
-    printf("Waiting List:\n");
-    while (current != NULL)
-    {
-        printf("Process ID: %d\n", current->id);
-        current = current->next;
-    }
+    printf("Waiting List: %d processes\n", waiting_count);
 }
 
-void sending_arrival_processes(int *next_process_idx, int processCount, int current_time, int *processes_sent)
+void sending_arrival_processes(int *next_process_idx, int processCount, int current_time)
 {
     while (*next_process_idx < processCount &&
            process_list[*next_process_idx].arrival_time <= current_time)
     {
-        memory_block_t* memory = allocateMemory(memory_root, process_list[*next_process_idx].memory_size);
-        if(memory == NULL)
+        process_data* process = &process_list[*next_process_idx];
+        process->memory = allocateMemory(memory_root, process->memory_size);
+        if (!MEMORY_HANDLE_VALID(process->memory))
         {
             printf("added to waiting list\n");
-            waiting_list_add(&process_list[*next_process_idx]);
+            waiting_list_add(process);
             print_waiting_list();
         }
         else
         {
-            
-            log_memory_stats(&process_list[*next_process_idx], "allocated", current_time, memory->start, memory->end);
-            process_data* process = &process_list[*next_process_idx];
-            *processes_sent += sending_process(process, current_time);
-            memory->processId = process->pid;
+            log_memory_stats(process, EVENT_ALLOCATED, current_time, process->memory.start, MEMORY_HANDLE_END(process->memory));
+            sending_process(process, current_time);
+            setMemoryOwner(memory_root, process->memory, process->pid);
         }
         (*next_process_idx)++;
     }
 }
 
-void there_is_no_processes(int processes_sent)
+// Refresh the generator's section of the live metrics page
+void publish_generator_stats(int next_process_idx, int processCount, int current_time)
 {
-    ProcessMessage msg;
-    msg.mtype = 1; // Any positive number
-    if (processes_sent == 0)
+    if (!channelsG.stats)
+        return;
+    stats_generator_section_t *section = &channelsG.stats->generator;
+    stats_page_begin(&section->seq);
+    section->time = current_time;
+    section->tick_lag = get_clk() - current_time;
+    section->jobs = processCount;
+    section->arrived = next_process_idx;
+    section->waiting = waiting_count;
+    section->min_order = memory_root->minOrder;
+    section->max_order = memory_root->maxOrder;
+    section->free_bytes = 0;
+    for (int order = memory_root->minOrder; order <= memory_root->maxOrder && order < STATS_PAGE_MAX_ORDERS; order++)
     {
-        msg.mtype = 1; // Any positive number
-        msg.process_id = -1;
-        msg.arrival_time = 0;
-        msg.runtime = 0;
-        msg.priority = 0;
-
-        if (msgsnd(arrG_msgq_id, &msg, sizeof(msg) - sizeof(long), 0) == -1)
-        {
-            perror("Error sending no-process message");
-        }
+        int count = memory_root->freeLists[order - memory_root->minOrder].count;
+        section->free_blocks[order] = count;
+        section->free_bytes += (int64_t)count << order;
     }
+    stats_page_end(&section->seq);
 }
 
-// Notify the scheduler when a process finishes
-
-void notifySchedulerFinishedProcess(pid_t pid)
+// Earliest tick at which the generator has something to do on its own.
+// Waiting processes only become admissible when memory is freed, which
+// happens on a scheduler event, so they do not schedule a tick themselves.
+int next_generator_event(int next_process_idx, int processCount, int current_time)
 {
-    CompletionMessage msg;
-    msg.mtype = 1;
-    msg.process_id = pid;
-    msg.finish_time = get_clk();
-    memory_block_t* memory = findMemoryBlockByProcessId(memory_root, pid);
-    process_data* process = get_process_by_pid(pid);
-    log_memory_stats(process, "freed", msg.finish_time, memory->start, memory->end);
-    deallocate_memory(memory_root, pid); // Deallocate memory for the finished process   (
-
-    if (msgsnd(compG_msgq_id, &msg, sizeof(msg) - sizeof(long), 0) == -1)
+    if (next_process_idx < processCount)
     {
-        perror("Error sending completion message");
+        return process_list[next_process_idx].arrival_time;
     }
-    
+    if (waiting_count == 0)
+    {
+        return current_time + 1; // Termination message goes out next tick
+    }
+    return CLK_NEVER;
 }
 
-process_data* get_process_by_pid(pid_t pid)
+// Free the memory of a finished process and log it.
+// Returns 0 if pid does not belong to a simulated process.
+int release_process_memory(pid_t pid, int finish_time)
 {
-    for(int i = 0; i < MAX_PROCESSES; i++)
+    process_data* process = get_process_by_pid(pid);
+    if (process == NULL)
     {
-        if (process_list[i].pid == pid)
-        {
-            return &process_list[i];
-        }
+        return 0; // Not a simulated process (clock or scheduler exiting)
     }
-    return NULL; // Process not found
+    log_memory_stats(process, EVENT_FREED, finish_time, process->memory.start, MEMORY_HANDLE_END(process->memory));
+    freeMemory(memory_root, process->memory); // Deallocate memory for the finished process
+    memory_freed = 1;
+    hashMapRemove(process_by_pid, pid);
+    return 1;
 }
 
-int waiting_list_remove(process_data* process) {
-    if (waiting_list_HEAD == NULL || process == NULL) {
-        printf("Error: List is empty or invalid process pointer.\n");
-        return 0; // List is empty or invalid process
+// Tell the scheduler a child was reaped. Its memory is freed once the
+// scheduler reports the job on the finished ring, so that memory.log
+// follows the scheduler's CPU order rather than the order of the exits.
+void notifySchedulerFinishedProcess(pid_t pid)
+{
+    if (get_process_by_pid(pid) == NULL)
+    {
+        return; // Clock or scheduler exiting
     }
+    // Only the pid: the free is stamped with the scheduler's tick, which
+    // the reap may run ahead of in real time
+    CompletionRecord rec = {0};
+    rec.pid = pid;
 
-    if (waiting_list_HEAD == process) {
-        printf("Removing process %d from the head of the list.\n", process->id);
-        waiting_list_HEAD = waiting_list_HEAD->next;
-        if (waiting_list_HEAD == NULL) {
-            waiting_list_TAIL = NULL; // List is now empty
-        }
-        return 1; // Successfully removed
+    // Only this handler produces on the exits ring
+    if (!shmRingPush(channelsG.exits, &rec))
+    {
+        printf("Error: exit ring is full\n");
     }
+    shmRingPublish(channelsG.exits);
+
+}
 
-    process_data* current = waiting_list_HEAD;
-    while (current->next != NULL && current->next != process) {
-        current = current->next;
+// The scheduler reports every finished job, all before it finishes
+// STAGE_COMPLETIONS for the tick
+void receive_finished_jobs()
+{
+    CompletionRecord rec;
+    // The SIGCHLD handler reads process_by_pid, which this removes from
+    sigprocmask(SIG_BLOCK, &sigchld_set, NULL);
+    while (shmRingPop(channelsG.finished, &rec))
+    {
+        release_process_memory(rec.pid, rec.finish_time);
     }
+    sigprocmask(SIG_UNBLOCK, &sigchld_set, NULL);
+}
 
-    if (current->next == process) {
-        printf("Removing process %d from the list.\n", process->id);
-        current->next = process->next;
-        if (waiting_list_TAIL == process) {
-            waiting_list_TAIL = current; // Update tail if necessary
-        }
-        return 1; // Successfully removed
+process_data* get_process_by_pid(pid_t pid)
+{
+    return (process_data*)hashMapGet(process_by_pid, pid); // NULL if not a simulated process
+}
+
+void waiting_list_remove(process_data* process) {
+    int order = process->memory_order;
+    if (waiting_list_HEAD[order] != process) {
+        printf("Process %d is not at the head of its waiting list.\n", process->id);
+        return;
     }
 
-    printf("Process %d not found in the waiting list.\n", process->id);
-    return 0; // Process not found
+    waiting_list_HEAD[order] = process->next;
+    if (waiting_list_HEAD[order] == NULL) {
+        waiting_list_TAIL[order] = NULL; // Bucket is now empty
+    }
+    process->next = NULL;
+    waiting_count--;
 }
 
 void waiting_list_add(process_data* process)
 {
-    if (waiting_list_HEAD == NULL)
+    int order = memoryOrderFor(memory_root, process->memory_size);
+    process->memory_order = order;
+    process->next = NULL;
+    if (waiting_list_HEAD[order] == NULL)
     {
-        waiting_list_HEAD = process;
-        waiting_list_TAIL = process;
-        process->next = NULL;
+        waiting_list_HEAD[order] = process;
     }
     else
     {
-        waiting_list_TAIL->next = process;
-        waiting_list_TAIL = process;
-        process->next = NULL;
+        waiting_list_TAIL[order]->next = process;
     }
+    waiting_list_TAIL[order] = process;
+    waiting_count++;
 }
 
-void log_memory_stats(process_data* process, char* state, int current_time, int start, int end) {
-    (strcmp(state, "allocated") == 0) ? fprintf(memoryLogFile, "At time %d %s %d bytes for process %d from %d to %d\n",
-        current_time, state, process->memory_size, process->id, start, end - 1) :
-    fprintf(memoryLogFile, "At time %d %s %d bytes from process %d from %d to %d\n",
-        current_time, state, process->memory_size, process->id, start, end - 1); 
-    fflush(memoryLogFile);
+// Processes join the waiting list in process_list order, so among the bucket
+// heads that fit, the lowest address is the one that has waited longest.
+// Allocating it can only shrink what fits, so taking these one at a time
+// admits exactly the processes a full FIFO pass would.
+process_data* waiting_list_next_fitting()
+{
+    int largest = largestFreeOrder(memory_root);
+    process_data* next = NULL;
+    for (int order = 0; order <= largest && order < WAITING_ORDERS; order++)
+    {
+        process_data* head = waiting_list_HEAD[order];
+        if (head != NULL && (next == NULL || head < next))
+        {
+            next = head;
+        }
+    }
+    return next;
+}
+
+void log_memory_stats(process_data* process, int event, int current_time, long start, long end) {
+    event_record_t record;
+    record.time = current_time;
+    record.id = process->id;
+    record.type = event;
+    record.cpu = -1;
+    record.size = process->memory_size;
+    record.u.memory.start = start;
+    record.u.memory.end = end - 1;
+    event_log_append(memoryLogFile, &record);
 }
 
 // Function to clean up resources
@@ -602,28 +836,21 @@ void clear_resources(int signum)
     printf("Cleaning up resources...\n");
 
 
-    while(waiting_list_HEAD != NULL)
+    for (int order = 0; order < WAITING_ORDERS; order++)
     {
-        waiting_list_remove(waiting_list_HEAD);
+        waiting_list_HEAD[order] = waiting_list_TAIL[order] = NULL;
     }
-    // Remove message queue if it exists
-    if (arrG_msgq_id != -1)
+    waiting_count = 0;
+    if (slots_shm_id != -1)
     {
-        msgctl(arrG_msgq_id, IPC_RMID, NULL);
+        shmctl(slots_shm_id, IPC_RMID, NULL); // Gone once the last process detaches
     }
-    printf("\033[1;31m");
-    printf("[Process Generator] ");
-    printf("\033[0m");
-    printf("Arrived Message queue removed\n");
 
-    if (compG_msgq_id != -1)
-    {
-        msgctl(compG_msgq_id, IPC_RMID, NULL);
-    }
-    printf("\033[1;31m");
-    printf("[Process Generator] ");
-    printf("\033[0m");
-    printf("Completed Message queue removed\n");
+    event_log_close(memoryLogFile);
+    memoryLogFile = NULL;
+
+    stats_page_destroy(channelsG.stats, 1);
+    channelsG.stats = NULL;
 
     // Kill scheduler if it exists
     if (scheduler_pid > 0)
@@ -645,4 +872,4 @@ void clear_resources(int signum)
 
 //os-sim
 //arrived remove
-//process dec rmeining
\ No newline at end of file
+//process dec rmeining
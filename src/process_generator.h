@@ -1,4 +1,4 @@
-#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // POSIX.1-2008 plus the BSD/SVID extras
 #include <stdio.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -8,14 +8,15 @@
 #include "clk.h"
 #include "scheduler.h"
 #include <sys/ipc.h>
-#include <sys/msg.h>
 #include <sys/shm.h>
 #include <errno.h>
+#include <limits.h>
 #include "memory.h"
+#include "models/HashMap/hashMap.h"
 
 
-#define MAX_PROCESSES 100
 #define MAX_LINE_LENGTH 256
+#define WAITING_ORDERS 32   // Buddy orders a waiting process can need (sizes < 2^31)
 
 // Structure to hold process data
 struct process_data
@@ -27,27 +28,37 @@ struct process_data
     pid_t pid;
     int completed;
     int memory_size;
+    memory_handle_t memory;    // Block held while the process is alive
+    int memory_order;          // Buddy order it needs, set while it waits
     struct process_data* next; // Pointer to the next process in the list
 };
 typedef struct process_data process_data;
 
 void sigchld_handler(int sig);
-int read_processes(const char *filename, process_data process_list[]);
+int read_processes(const char *filename, process_data **process_list);
+int drop_unfittable_processes(process_data process_list[], int count, long max_request);
 void display_processes(process_data process_list[], int count);
-int check_no_more_processes(int processes_sent, int processCount);
+int check_no_more_processes(int next_process_idx, int processCount, int current_time);
 void notifySchedulerFinishedProcess(pid_t pid);
 void clear_resources(int signum);
 void signals_handling();
-void arguments_Reader(int argc, char *argv[], int *algorithm_type, int *quantum, int *processCount, process_data process_list[]);
+void arguments_Reader(int argc, char *argv[], const scheduler_policy_t **policy, policy_options_t *policy_options, int *cpu_count, int *backend, int *processCount, process_data **process_list, memory_config_t *memory_config);
+int parse_quanta(const char *text, policy_options_t *policy_options);
+ProcessSlot* create_process_slots(int count);
+pid_t spawn_process(process_data * process, int slot);
 int sending_process(process_data * process, int current_time);
-void sending_waiting_proccess (int current_time, int *processes_send);
-void sending_arrival_processes(int *next_process_idx, int processCount, int current_time, int *processes_sent);
-void there_is_no_processes(int processes_sent);
+int release_process_memory(pid_t pid, int finish_time);
+void receive_finished_jobs();
+void sending_waiting_proccess (int current_time);
+void sending_arrival_processes(int *next_process_idx, int processCount, int current_time);
+int next_generator_event(int next_process_idx, int processCount, int current_time);
+void publish_generator_stats(int next_process_idx, int processCount, int current_time); // Refresh the generator's section of the live metrics page
 void clear_resources(int);
-int waiting_list_remove(process_data* process);               // Remove a process from the waiting list
-void waiting_list_add(process_data* process);                  // Add a process to the list
-void log_memory_stats(process_data* process, char* state, int current_time, int start, int end) ;
+void waiting_list_remove(process_data* process);              // Remove a process from the head of its bucket
+void waiting_list_add(process_data* process);                  // Add a process to the bucket of its order
+process_data* waiting_list_next_fitting();                     // Earliest waiting process that fits now
+void log_memory_stats(process_data* process, int event, int current_time, long start, long end) ;
 process_data* get_process_by_pid(pid_t pid);
 
-void fancyPrintTree(memory_block_t *root, int level);
-void fancyPrintMemoryBar(memory_block_t *root);
\ No newline at end of file
+void fancyPrintTree(buddy_allocator_t *memory, int level);
+void fancyPrintMemoryBar(buddy_allocator_t *memory);
\ No newline at end of file
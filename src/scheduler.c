@@ -1,100 +1,185 @@
 #include "scheduler.h"
+#include "futex.h"
 #include <errno.h> // Ensure this is included
 #include <math.h>
+#include <time.h>
 
 
 
-int algorithm;          
-int quantum;   
-int arr_msgq_id;
-int comp_msgq_id;          
-FILE* logFile;         
-void* readyQueue;        
-PCB* PCB_table_head = NULL;
-PCB* PCB_table_tail = NULL;
+const scheduler_policy_t* policy; // Owns the ready sets and decides who runs
+CPU* cpus = NULL;                 // Simulated CPUs, each with its own ready queue
+int cpu_count = 1;
+int backend = BACKEND_FORK;
+SchedulerChannels channels;  // Rings to and from the generator
+event_log_t* logFile = NULL; // scheduler.log, written in batches
+Slab* PCB_slab = NULL;       // Contiguous PCB storage
+HashMap* PCB_by_pid = NULL;  // Live PCBs keyed by system pid
+HashMap* PCB_by_id = NULL;   // Live PCBs keyed by process id
 int process_count = 0;   
 int static_process_count=0;
-int first_time = 0;
-int first_arrival_time;
-PCB* running_process = NULL; 
 int current_time = -1;  
 int actual_running_time = 0; 
-int time_slice = 0;      
 int terminated = 0;  
 int KEY = 300;   
 
 int process_not_arrived = 1; // Flag to indicate if there is a processes that haven't arrived
 
-int TA_Array[MAX_PROCESSES];
-double WTA_Array[MAX_PROCESSES];
-double waiting = 0;
+JobStats job_stats;
+int stats_interval = 0;     // Set by the generator before the fork, see set_stats_interval()
+int next_stats_snapshot = 0;
+FILE* statsFile = NULL;
+int tick_lag = 0;           // Clock ticks past current_time when the last dispatch ended
 
-void initialize(int alg, int q)
+// Phases of a tick, timed with -T. The tick is their sum: the time spent
+// waiting for the generator is not the scheduler's own.
+enum
 {
-    algorithm = alg;
-    quantum = q;
+    PHASE_UPDATE = 0,  // update_process_times()
+    PHASE_COMPLETIONS, // handle_finished_process()
+    PHASE_ARRIVALS,    // check_arrivals()
+    PHASE_DISPATCH,    // balance_load() and check_context_switch()
+    PHASE_TICK,
+    PHASE_COUNT
+};
+static const char* phase_names[PHASE_COUNT] = {"update", "completions", "arrivals", "dispatch", "tick"};
+int latency_tracing = 0;                 // Set by the generator before the fork
+LatencyHistogram* phase_latency = NULL;  // PHASE_COUNT histograms, only with -T
+uint64_t tick_busy = 0;                  // ns spent in this tick's phases so far
+long ticks_missed = 0;                   // Real-time ticks the loop never saw
+int tick_skips = 0;
+int largest_skip = 0;
+
+void set_latency_tracing(int enabled)
+{
+    latency_tracing = enabled;
+}
 
-    signal(SIGINT, (void (*)(int))cleanup);
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
+// Start timing a phase; free when -T is off
+static uint64_t phase_start()
+{
+    return phase_latency ? now_ns() : 0;
+}
 
-    for (int i = 0; i < MAX_PROCESSES; i++) TA_Array[i] = -1;
-    for (int i = 0; i < MAX_PROCESSES; i++) WTA_Array[i] = -1;
-    
+// Charge the time since `since` to `phase` and return the new mark
+static uint64_t phase_mark(int phase, uint64_t since)
+{
+    if (!phase_latency)
+        return 0;
+    uint64_t now = now_ns();
+    latencyHistogramRecord(&phase_latency[phase], now - since);
+    tick_busy += now - since;
+    return now;
+}
+
+static void phase_end_tick()
+{
+    if (!phase_latency)
+        return;
+    latencyHistogramRecord(&phase_latency[PHASE_TICK], tick_busy);
+    tick_busy = 0;
+}
+
+// The real-time clock moved more than once while the loop was busy or
+// descheduled: those ticks were simulated in one step, late
+static void note_missed_ticks(int missed)
+{
+    ticks_missed += missed;
+    tick_skips++;
+    if (missed > largest_skip)
+        largest_skip = missed;
     printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-    printf(algorithm == HPF ? "Using HPF algorithm\n" :
-           algorithm == SRTN ? "Using SRTN algorithm\n" :
-           algorithm == RR ? "Using RR algorithm\n" : "Unknown algorithm\n");
-    switch(algorithm) {
-        case HPF:
-            readyQueue = createMinHeap(MAX_PROCESSES, compare_priority);
-            printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-            printf("Scheduler started with Highest Priority First algorithm\n");
-            break;
-        case SRTN:
-            printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-            printf("Scheduler started with Shortest Remaining Time Next algorithm\n");
-            readyQueue = createMinHeap(MAX_PROCESSES, compare_remaining_time);
-            break;
-        case RR:
-            readyQueue = createQueue();
-            printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-            printf("Scheduler started with Round Robin algorithm, quantum = %d\n", quantum);
-            break;
+    printf("Fell behind the clock: %d tick%s missed before time %d\n", missed, missed > 1 ? "s" : "", current_time + missed + 1);
+}
 
-    }
+void set_stats_interval(int ticks)
+{
+    stats_interval = ticks;
+}
 
-    // Create log file
-    logFile = fopen("scheduler.log", "w");
-    if (!logFile)
+void initialize(const scheduler_policy_t* pol, const policy_options_t* options, int be, int num_cpus, int expected_jobs, const SchedulerChannels* ch)
+{
+    policy = pol;
+    backend = be;
+    cpu_count = num_cpus;
+
+    signal(SIGINT, (void (*)(int))cleanup);
+
+    runningStatsInit(&job_stats.wta);
+    runningStatsInit(&job_stats.waiting);
+    runningStatsInit(&job_stats.ta);
+    quantileSketchInit(&job_stats.wta_quantiles);
+    quantileSketchInit(&job_stats.waiting_quantiles);
+    quantileSketchInit(&job_stats.ta_quantiles);
+
+    // Tables start at the job count read from the input and grow past it
+    PCB_slab = createSlab(sizeof(PCB), PCB_CHUNK);
+    PCB_by_pid = createHashMap(expected_jobs);
+    PCB_by_id = createHashMap(expected_jobs);
+    if (!PCB_slab || !PCB_by_pid || !PCB_by_id)
     {
-        perror("Failed to open log file");
+        perror("Failed to allocate the PCB table");
         exit(1);
     }
+    
+    printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+    printf("Using %s algorithm on %d CPU%s\n", policy->label, cpu_count, cpu_count > 1 ? "s" : "");
+    cpus = calloc(cpu_count, sizeof(CPU));
+    if (!cpus)
+    {
+        perror("Failed to allocate the CPUs");
+        exit(1);
+    }
+    for (int i = 0; i < cpu_count; i++)
+    {
+        cpus[i].id = i;
+        cpus[i].ready = policy->create(options, expected_jobs / cpu_count + 1);
+        if (!cpus[i].ready)
+        {
+            perror("Failed to create the ready queue");
+            exit(1);
+        }
+    }
+
+    // Create log file
+    logFile = event_log_open("scheduler.log", EVENT_LOG_SCHEDULER);
     if (!logFile)
     {
         perror("Failed to open log file");
         exit(1);
     }
-    fprintf(logFile, "#At time x process y state arr w total z remain y wait k\n");    
 
-    // Open arrival message queue
-    key_t arr_key = ftok("keyfile", 'a');
-    arr_msgq_id = msgget(arr_key, 0666);
-    if (arr_msgq_id == -1)
+    if (latency_tracing)
     {
-        perror("Error accessing arrival message queue");
-        return ;
+        phase_latency = malloc(sizeof(LatencyHistogram) * PHASE_COUNT);
+        if (!phase_latency)
+        {
+            perror("Failed to allocate the latency histograms");
+            exit(1);
+        }
+        for (int i = 0; i < PHASE_COUNT; i++)
+            latencyHistogramInit(&phase_latency[i]);
     }
 
-    // Open completion message queue
-    key_t comp_key = ftok("keyfile", 'c');
-    comp_msgq_id = msgget(comp_key, 0666);
-    if (comp_msgq_id == -1)
+    if (stats_interval > 0)
     {
-        perror("Error accessing completion message queue");
-        return ;
+        statsFile = fopen(STATS_SNAPSHOT_FILE, "w");
+        if (!statsFile)
+        {
+            perror("Failed to open stats file");
+            exit(1);
+        }
+        next_stats_snapshot = stats_interval;
     }
 
+    channels = *ch;
+
     sync_clk();
 
 
@@ -108,333 +193,425 @@ void run_scheduler()
 {
     while (!terminated)
     {
-        int new_time = get_clk();
-        if (new_time > current_time)
+        // Sleep until the clock publishes the next tick
+        int new_time = wait_next_tick(current_time);
+        // In fast-forward mode several ticks pass between two visits
+        int elapsed = new_time - current_time;
+        if (elapsed > 1 && current_time >= 0 && !is_fast_forward())
         {
-            current_time = new_time;
+            note_missed_ticks(elapsed - 1);
+        }
+        current_time = new_time;
+
+        // Advance the running processes and retire the ones that finished
+        uint64_t mark = phase_start();
+        update_process_times(elapsed);
+        phase_mark(PHASE_UPDATE, mark);
+        wait_for_exits();
+        mark = phase_start();
+        handle_finished_process();
+        phase_mark(PHASE_COMPLETIONS, mark);
+        finish_stage(STAGE_COMPLETIONS, current_time, CLK_NEVER);
+
+        // The generator admits this tick's arrivals only after our completions
+        if (process_not_arrived)
+        {
+            wait_stage(STAGE_ARRIVALS, current_time);
+        }
+        mark = phase_start();
+        check_arrivals();
+        mark = phase_mark(PHASE_ARRIVALS, mark);
+        balance_load();
+        
+        // Select next process if needed
+        check_context_switch();
+        phase_mark(PHASE_DISPATCH, mark);
+        phase_end_tick();
 
-            // Check if process finished
-            if (running_process && running_process->remaining_time >= 0)
-            {
-                update_process_times();
-            }
-            if (running_process && running_process->remaining_time <= 0)
-            {
-                handle_finished_process();
-            }
+        tick_lag = get_clk() - current_time;
+        finish_stage(STAGE_DISPATCH, current_time, next_scheduler_event());
 
-            check_arrivals();
-            
-            // Select next process if needed
-            check_context_switch();
-            
+        // Off the tick's critical path: the others already carry on
+        publish_stats();
+        if (statsFile && current_time >= next_stats_snapshot)
+        {
+            snapshot_job_stats();
+            next_stats_snapshot = (current_time / stats_interval + 1) * stats_interval;
         }
     }
+    retire_stage(STAGE_COMPLETIONS);
+    retire_stage(STAGE_DISPATCH);
+    publish_stats();
     log_performance_stats();
+    log_latency_stats();
 }
 
-void check_context_switch()
+// Jobs queued on or running on a CPU
+static int cpu_load(CPU *cpu)
 {
-    PCB *next_process = select_next_process();
+    return policy->size(cpu->ready) + (cpu->running != NULL);
+}
 
-    if (next_process != running_process)
+// No CPU runs anything and every ready queue is empty
+static int all_cpus_idle()
+{
+    for (int i = 0; i < cpu_count; i++)
     {
-        if (running_process && running_process->remaining_time > 0)
-        {
-            stop_process(running_process);
-        }
-        running_process = next_process;
-        if (running_process)
-        {
-            start_process(running_process);
-        }
+        if (cpus[i].running || !Empty(cpus[i].ready))
+            return 0;
     }
+    return 1;
 }
 
-// Check for newly arrived processes from the message queue
-
-void check_arrivals()
+// New jobs go to the CPU with the least work, lowest id on ties
+static CPU *least_loaded_cpu()
 {
-    ProcessMessage msg;
-    int processes_received = 0; // Track processes received this tick
-    // Only check messages if we expect new processes
-    if (process_not_arrived)
+    CPU *best = &cpus[0];
+    for (int i = 1; i < cpu_count; i++)
     {
-        while (true)
-        {
-            // Blocking msgrcv to wait for a message
-            ssize_t received = msgrcv(arr_msgq_id, &msg, sizeof(msg) - sizeof(long), 0, 0);
-            if (received == -1)
-            {
-                perror("Error receiving message");
-                return;
-            }
-
-
-            if (msg.process_id == -2) {
-                printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-                printf("Received no more processes signal at time %d\n", current_time);
-                process_not_arrived = false;
-                if (running_process == NULL && Empty(readyQueue))
-                {
-                    terminated = true;
-                }
-                return; 
-            }
-            else if (msg.process_id == -1)
-            {
-                // No process this tick, only exit if no processes were received
-                if (processes_received == 0)
-                {
-                    return;
-                }
-                // Otherwise, continue checking for more process messages
-                continue;
-            }
-
-            // Handle new process
-            PCB *new_process = (PCB *)malloc(sizeof(PCB));
-            if (!new_process)
-            {
-                perror("Failed to allocate memory for PCB");
-                continue;
-            }
-            new_process->id = msg.process_id;
-            new_process->arrival_time = msg.arrival_time;
-            new_process->runtime = msg.runtime;
-            new_process->remaining_time = msg.runtime;
-            new_process->priority = msg.priority;
-            new_process->pid = msg.pid;       // Get the PID from the message
-            new_process->shm_id = msg.shm_id; // Get the shared memory ID from the message
-            new_process->wait_time = 0;
-            new_process->start_time = -1;
-            new_process->status = READY;
-            // Attach to the shared memory
-            int *shm_ptr = (int *)shmat(msg.shm_id, NULL, 0);
-            if (new_process->shm_ptr == (int *)-1)
-            {
-                perror("Failed to attach to shared memory in scheduler");
-                free(new_process);
-                continue;
-            }
-
-            new_process->shm_ptr = shm_ptr; // Store the pointer to shared memory
-
-            printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-            printf("Received new process %d at time %d\n", new_process->id, current_time);
-            // log_process_state(new_process, "arrived");
-
-            // Add to processes array
-            static_process_count++;
-            actual_running_time += new_process->runtime;
-            PCB_add(new_process);
+        if (cpu_load(&cpus[i]) < cpu_load(best))
+            best = &cpus[i];
+    }
+    return best;
+}
 
-            // Add to ready queue
-            switch (algorithm)
-            {
-            case HPF:
-                insertMinHeap(readyQueue, new_process);
-                break;
-            case SRTN:
-                insertMinHeap(readyQueue, new_process);
-                break;
-            case RR:
-                enqueue(readyQueue, new_process);
-                break;
-            }
+// The most loaded CPU with a waiting job and the least loaded CPU, if their
+// loads differ by two or more (moving a job would then even them out)
+static int find_imbalance(CPU **busiest, CPU **idlest)
+{
+    *busiest = NULL;
+    *idlest = &cpus[0];
+    for (int i = 0; i < cpu_count; i++)
+    {
+        if (!Empty(cpus[i].ready) && (!*busiest || cpu_load(&cpus[i]) > cpu_load(*busiest)))
+            *busiest = &cpus[i];
+        if (cpu_load(&cpus[i]) < cpu_load(*idlest))
+            *idlest = &cpus[i];
+    }
+    return policy->detach && *busiest && cpu_load(*busiest) - cpu_load(*idlest) >= 2;
+}
 
-            printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-            printf("Process %d arrived at time %d\n", new_process->id, current_time);
-            //log_process_state(new_process, "arrived");
-            processes_received++;
+// Move a waiting job from one CPU's ready queue to another's
+static PCB *migrate(CPU *from, CPU *to)
+{
+    PCB *process = policy->detach(from->ready);
+    if (process)
+    {
+        process->cpu = to->id;
+        policy->attach(to->ready, process);
+    }
+    return process;
+}
 
-            // Peek at the next message non-blocking
-            received = msgrcv(arr_msgq_id, &msg, sizeof(msg) - sizeof(long), 0, 0);
-            if (received == -1)
-            {
-                if (errno == ENOMSG)
-                {
-                    // No more messages, exit
-                    return;
-                }
-                else
-                {
-                    perror("Error peeking at message");
-                    return;
-                }
-            }
-            // Re-send the peeked message
-            if (msgsnd(arr_msgq_id, &msg, sizeof(msg) - sizeof(long), 0) == -1)
-            {
-                perror("Error re-sending message");
-                return;
-            }
+// Earliest tick at which a running process finishes, a policy needs to run
+// or a balancing pass would move something
+int next_scheduler_event()
+{
+    if (terminated)
+    {
+        return CLK_NEVER;
+    }
 
-            // If the next message is not a process message, exit
-            if (msg.process_id <= 0)
-            {
-                return;
-            }
-            if (msg.arrival_time != current_time)
+    int next = CLK_NEVER; // Idle until the generator sends something
+    for (int i = 0; i < cpu_count; i++)
+    {
+        PCB *running = cpus[i].running;
+        if (!running)
+        {
+            continue;
+        }
+        int remaining = running->remaining_time > 0 ? running->remaining_time : 1;
+        if (current_time + remaining < next)
+        {
+            next = current_time + remaining;
+        }
+        if (policy->next_event)
+        {
+            int policy_next = policy->next_event(cpus[i].ready, running, current_time);
+            if (policy_next < next)
             {
-                // If the next message is not for the current time, exit
-                return;
+                next = policy_next;
             }
         }
     }
 
-    // Update termination condition
-    if (!process_not_arrived && running_process == NULL && Empty(readyQueue))
+    // Loads only change at events, so a pass is only worth waking for if
+    // the CPUs are already out of balance
+    CPU *busiest, *idlest;
+    if (cpu_count > 1 && find_imbalance(&busiest, &idlest))
     {
-        terminated = true;
+        int next_balance = (current_time / BALANCE_INTERVAL + 1) * BALANCE_INTERVAL;
+        if (next_balance < next)
+        {
+            next = next_balance;
+        }
     }
-}
 
-// Update times for the running process
-void update_process_times()
-{
-    if (running_process && running_process->remaining_time > 0)
+    // Snapshots are due on their own ticks, so fast-forward stops there too
+    if (statsFile)
     {
-        running_process->remaining_time--;
-        *(running_process->shm_ptr) = running_process->remaining_time; // Update shared memory
-
-        if (algorithm == RR)
+        int next_snapshot = (current_time / stats_interval + 1) * stats_interval;
+        if (next_snapshot < next)
         {
-            time_slice++;
+            next = next_snapshot;
         }
     }
+    return next;
 }
 
-void handle_finished_process()
+// Every BALANCE_INTERVAL ticks, move waiting jobs from the busiest CPU to
+// the least loaded one until no two loads differ by more than one
+void balance_load()
 {
-    if (running_process && running_process->remaining_time <= 0)
+    if (cpu_count < 2 || current_time % BALANCE_INTERVAL != 0)
+    {
+        return;
+    }
+
+    CPU *busiest, *idlest;
+    while (find_imbalance(&busiest, &idlest))
     {
-        CompletionMessage msg;
-        if (msgrcv(comp_msgq_id, &msg, sizeof(msg) - sizeof(long), 0, !IPC_NOWAIT) == -1)
+        PCB *process = migrate(busiest, idlest);
+        if (!process)
         {
-            perror("Error receiving completion message");
+            break;
         }
-        running_process->ending_time = current_time;
+        idlest->balanced_in++;
         printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-        printf("Process %d finished at time %d\n", running_process->id, current_time);
-        log_process_state(running_process, "finished");
-
-        PCB_remove(running_process);
-
-        running_process = NULL;
-        time_slice = 0;
+        printf("Balancing: moved process %d from CPU %d to CPU %d\n", process->id, busiest->id, idlest->id);
     }
 }
 
-int compare_priority(void *a, void *b)
+// An idle CPU with nothing queued takes a waiting job from the busiest CPU
+// that has someone waiting behind its running job
+static int steal_work(CPU *thief)
 {
-    PCB *p1 = (PCB *)a;
-    PCB *p2 = (PCB *)b;
+    if (!policy->detach)
+    {
+        return 0;
+    }
 
-    // Lower priority number = higher priority
-    if (p1->priority != p2->priority)
+    CPU *victim = NULL;
+    for (int i = 0; i < cpu_count; i++)
+    {
+        CPU *cpu = &cpus[i];
+        if (cpu != thief && !Empty(cpu->ready) && (!victim || cpu_load(cpu) > cpu_load(victim)))
+            victim = cpu;
+    }
+    if (!victim || cpu_load(victim) < 2)
     {
-        return p1->priority - p2->priority;
+        return 0;
     }
 
-    // If priorities are equal, use arrival time as tiebreaker
-    return p1->arrival_time - p2->arrival_time;
+    PCB *process = migrate(victim, thief);
+    if (!process)
+    {
+        return 0;
+    }
+    thief->steals++;
+    printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+    printf("CPU %d stole process %d from CPU %d\n", thief->id, process->id, victim->id);
+    return 1;
 }
 
-int compare_remaining_time(void *a, void *b)
+void check_context_switch()
 {
-    PCB *p1 = (PCB *)a;
-    PCB *p2 = (PCB *)b;
-
-    // Lower remaining time = higher priority
-    if (p1->remaining_time != p2->remaining_time)
+    for (int i = 0; i < cpu_count; i++)
     {
-        return p1->remaining_time - p2->remaining_time;
-    }
+        CPU *cpu = &cpus[i];
+        PCB *next_process = select_next_process(cpu);
+        if (!next_process && steal_work(cpu))
+        {
+            next_process = select_next_process(cpu);
+        }
 
-    // If remaining times are equal, use arrival time as tiebreaker
-    return p1->arrival_time - p2->arrival_time;
+        if (next_process != cpu->running)
+        {
+            if (cpu->running && cpu->running->remaining_time > 0)
+            {
+                stop_process(cpu->running);
+                if (policy->on_preempt)
+                {
+                    policy->on_preempt(cpu->ready, cpu->running);
+                }
+                cpu->preemptions++;
+            }
+            cpu->running = next_process;
+            if (cpu->running)
+            {
+                cpu->dispatches++;
+                start_process(cpu->running);
+            }
+        }
+    }
 }
 
-// Select the next process to run based on the algorithm
-PCB *select_next_process()
+// Turn one record from the generator into a PCB on the least loaded CPU
+static void admit_arrival(const ArrivalRecord *rec)
 {
+    PCB *new_process = PCB_alloc();
+    if (!new_process)
+    {
+        perror("Failed to allocate memory for PCB");
+        return;
+    }
+    new_process->id = rec->process_id;
+    new_process->arrival_time = rec->arrival_time;
+    new_process->runtime = rec->runtime;
+    new_process->remaining_time = rec->runtime;
+    new_process->priority = rec->priority;
+    new_process->pid = rec->pid;       // Get the PID from the record
+    new_process->wait_time = 0;
+    new_process->start_time = -1;
+    new_process->status = READY;
+    // In-process jobs have no slot
+    new_process->slot = channels.slots ? &channels.slots[rec->slot] : NULL;
 
-    // If using RR and quantum expired, put process back in queue
+    printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+    printf("Received new process %d at time %d\n", new_process->id, current_time);
 
-    if (algorithm == RR && running_process && time_slice >= quantum) {
-        printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-        printf("Quantum expired for Process %d (remaining time: %d)\n", running_process->id, running_process->remaining_time);
+    // Add to processes array
+    static_process_count++;
+    actual_running_time += new_process->runtime;
+    PCB_add(new_process);
 
-        // Only enqueue if process still has remaining time, which should be the case anyways
-        if (running_process->remaining_time > 0)
-        {
-            enqueue(readyQueue, running_process);
-        }
+    // Add to the ready queue of the least loaded CPU
+    CPU *cpu = least_loaded_cpu();
+    new_process->cpu = cpu->id;
+    policy->on_arrival(cpu->ready, new_process);
 
-        PCB *next = NULL;
-        // running_process = NULL;
-        time_slice = 0;
+    printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+    printf("Process %d arrived at time %d\n", new_process->id, current_time);
+}
 
-        // Get next process from queue if available
-        if (!isEmpty(readyQueue))
+// Drain this tick's arrivals. The generator publishes them all at once
+// before it finishes STAGE_ARRIVALS, so an empty ring simply means nobody
+// arrived.
+void check_arrivals()
+{
+    ArrivalRecord rec;
+    // Only check the ring if we expect new processes
+    while (process_not_arrived && shmRingPop(channels.arrivals, &rec))
+    {
+        if (rec.process_id == ARRIVALS_DONE)
         {
-            next = (PCB *)dequeue(readyQueue);
+            printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+            printf("Received no more processes signal at time %d\n", current_time);
+            process_not_arrived = false;
+            break;
         }
+        admit_arrival(&rec);
+    }
 
-        return next;
+    // Update termination condition
+    if (!process_not_arrived && all_cpus_idle())
+    {
+        terminated = true;
     }
+}
 
-    if (running_process)
+// Update times for the running processes
+void update_process_times(int elapsed)
+{
+    for (int i = 0; i < cpu_count; i++)
     {
-        switch (algorithm)
+        PCB *running = cpus[i].running;
+        if (!running || running->remaining_time <= 0)
         {
-        case HPF:
-            // HPF is non-preemptive, continue with current process
-            return running_process;
+            continue;
+        }
+        // Never run past completion if the clock moved more than one tick
+        int ran = elapsed > running->remaining_time ? running->remaining_time : elapsed;
+        running->remaining_time -= ran;
+        cpus[i].busy_ticks += ran;
+        publish_slot(running); // Update shared memory
 
-        case SRTN:
-            if (!isEmpty(readyQueue))
-            {
-                PCB *top = getMin(readyQueue);
-                if (top && top->remaining_time < running_process->remaining_time)
-                {
-                    // Preempt current process
-                    insertMinHeap(readyQueue, running_process);
-                    return (PCB *)extractMin(readyQueue);
-                }
-            }
-            return running_process;
+        if (policy->on_tick)
+        {
+            policy->on_tick(cpus[i].ready, running, ran);
+        }
+    }
+}
 
-        case RR:
-            return running_process;
+// Write the remaining time and state to the process's slot. The process
+// sleeps until its remaining time reaches zero, so only a running process
+// that just got there is woken.
+void publish_slot(PCB *process)
+{
+    ProcessSlot *slot = process->slot;
+    if (!slot)
+        return; // In-process job, nobody to tell
+    __atomic_store_n(&slot->remaining_time, process->remaining_time, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&slot->state, process->status, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&slot->seq, 1, __ATOMIC_RELEASE);
+    if (process->remaining_time == 0 && process->status == RUNNING)
+    {
+        futex_wake_all(&slot->remaining_time);
+    }
+}
 
-        default:
-            return running_process;
+// With the fork backend, wait until the generator reaped every process
+// that finished this tick, in whatever order they exited
+void wait_for_exits()
+{
+    if (backend != BACKEND_FORK)
+        return;
+    CompletionRecord rec;
+    for (int i = 0; i < cpu_count; i++)
+    {
+        if (!cpus[i].running || cpus[i].running->remaining_time > 0)
+            continue;
+        shmRingPopWait(channels.exits, &rec);
+        PCB *done = PCB_find_by_pid(rec.pid);
+        if (!done || done->status != RUNNING || done->remaining_time > 0)
+        {
+            printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+            printf("Completion for pid %d does not match a running process\n", rec.pid);
         }
     }
+}
 
-    // No running process, get one from the ready queue
-    switch (algorithm)
-    {
-    case HPF:
-    case SRTN:
-        if (!isEmpty(readyQueue))
+void handle_finished_process()
+{
+    CompletionRecord rec;
+    for (int i = 0; i < cpu_count; i++)
+    {
+        CPU *cpu = &cpus[i];
+        PCB *running = cpu->running;
+        if (!running || running->remaining_time > 0)
+            continue;
+
+        // The generator frees memory in this order, whichever child was
+        // reaped first
+        rec.pid = running->pid;
+        rec.finish_time = current_time;
+        if (!shmRingPush(channels.finished, &rec))
         {
-            return (PCB *)extractMin(readyQueue);
+            printf("Error: finished-job ring is full\n");
         }
-        break;
+        running->ending_time = current_time;
+        running->status = FINISHED;
+        publish_slot(running);
+        printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
+        printf("Process %d finished at time %d\n", running->id, current_time);
+        log_process_state(running, EVENT_FINISHED);
 
-    case RR:
-        if (!isEmpty(readyQueue))
+        if (policy->on_finish)
         {
-            return (PCB *)dequeue(readyQueue);
+            policy->on_finish(cpu->ready, running);
         }
-        break;
+        PCB_remove(running);
+
+        cpu->running = NULL;
     }
+    // The generator frees their memory after STAGE_COMPLETIONS
+    shmRingPublish(channels.finished);
+}
 
-    // No process to run
-    return NULL;
+// Select the next process to run on a CPU based on the policy
+PCB *select_next_process(CPU *cpu)
+{
+    return policy->pick_next(cpu->ready, cpu->running, current_time);
 }
 
 void start_process(PCB *process)
@@ -451,32 +628,29 @@ void start_process(PCB *process)
         process->wait_time = current_time - process->arrival_time;
 
         // Update shared memory with current remaining time
-        *(process->shm_ptr) = process->remaining_time;
+        publish_slot(process);
 
         
         printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
         printf("Starting process %d at time %d\n", process->id, current_time);
-        if (first_time == 0) {
-            first_arrival_time = current_time;
-            first_time = 1;
-        }
 
         // No need to fork as the process is already running
-        log_process_state(process, "started");
+        log_process_state(process, EVENT_STARTED);
     }
     else
     {
         // Resume the process
-        *(process->shm_ptr) = process->remaining_time;
+        publish_slot(process);
         printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
         printf("Resuming process %d at time %d\n", process->id, current_time);
         process->status = RUNNING;
-        log_process_state(process, "resumed");
+        log_process_state(process, EVENT_RESUMED);
     }
 
-    kill(process->pid, SIGCONT);
-
-    time_slice = 0;
+    if (backend == BACKEND_FORK)
+    {
+        kill(process->pid, SIGCONT);
+    }
 }
 
 // Stop a process
@@ -490,48 +664,50 @@ void stop_process(PCB *process)
         // Only stop if process is running and not finished
         printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
         printf("Stopping process %d (remaining time: %d)\n", process->id, process->remaining_time);
-        printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
-        printf("first arrival time %d\n", first_arrival_time);
 
-        kill(process->pid, SIGSTOP);
+        if (backend == BACKEND_FORK)
+        {
+            kill(process->pid, SIGSTOP);
+        }
         // current_shm_ptr = NULL; // Reset shared memory pointer
         process->status = READY;
-        log_process_state(process, "stopped");
+        publish_slot(process);
+        log_process_state(process, EVENT_STOPPED);
     }
 }
 
 // Log process state changes
 
-void log_process_state(PCB* process, char* state) {
+void log_process_state(PCB* process, int event) {
     if (!process || !logFile) return;
     process->wait_time = current_time - process->arrival_time - (process->runtime - process->remaining_time);
-    if(strcmp(state,"finished")!=0)
-    {
-        fprintf(logFile, "At time %d process %d %s arr %d total %d remain %d wait %d\n",
-            current_time, process->id, state, process->arrival_time,
-            process->runtime, process->remaining_time, process->wait_time); 
-    }
-    else
+
+    event_record_t record;
+    record.time = current_time;
+    record.id = process->id;
+    record.type = event;
+    record.cpu = cpu_count > 1 ? process->cpu : -1;
+    record.size = 0;
+    record.u.process.arrival = process->arrival_time;
+    record.u.process.total = process->runtime;
+    record.u.process.remain = process->remaining_time;
+    record.u.process.wait = process->wait_time;
+    record.u.process.ta = 0;
+    record.u.process.has_wta = 0;
+    record.u.process.wta = 0;
+    if (event == EVENT_FINISHED)
     {
         int TA = process->ending_time - process->arrival_time;
         if (process->runtime > 0)
         {
             double WTA = (double)TA / process->runtime;
-            WTA = round(WTA * 100) / 100;
-            fprintf(logFile, "At time %d process %d %s arr %d total %d remain %d wait %d TA %d WTA %.2f\n",
-                    current_time, process->id, state, process->arrival_time,
-                    process->runtime, process->remaining_time, process->wait_time, TA, WTA);
-            WTA_Array[process->id - 1] = WTA;
+            record.u.process.has_wta = 1;
+            record.u.process.wta = round(WTA * 100) / 100;
         }
-        else
-        {
-            fprintf(logFile, "At time %d process %d %s arr %d total %d remain %d wait %d TA %d WTA Could not be calculated\n",
-                    current_time, process->id, state, process->arrival_time,
-                    process->runtime, process->remaining_time, process->wait_time, TA);
-        }
-        TA_Array[process->id - 1] = TA;
+        record.u.process.ta = TA;
+        record_job_stats(TA, process->wait_time, process->runtime);
     }
-    fflush(logFile);
+    event_log_append(logFile, &record);
 }
 
 void log_performance_stats()
@@ -542,102 +718,180 @@ void log_performance_stats()
         perror("Failed to open performance file");
         exit(1);
     }
-    double CPU_utilization = (actual_running_time / (double)(current_time)) * 100;
+    double CPU_utilization = (actual_running_time / ((double)current_time * cpu_count)) * 100;
     CPU_utilization = round(CPU_utilization * 100) / 100;
     fprintf(perfLogFile, "CPU utilization = %.2f %%\n", CPU_utilization);
-    double WTA_sum = 0;
-    for (int i = 0; i < static_process_count; i++)
-    {
-        if (WTA_Array[i] != -1)
-            WTA_sum += WTA_Array[i];
-    }
-    double WTA_AVG = WTA_sum / static_process_count;
-
-    WTA_AVG = round(WTA_AVG * 100) /100;
-    fprintf(perfLogFile, "Avg WTA = %.2f\n", WTA_AVG);
-    double ans = waiting / static_process_count;
-    fprintf(perfLogFile, "Avg Waiting = %.2f\n", ans);
-    double diffSquared = 0;
-    for (int i = 0; i < static_process_count; i++)
-    {
-        diffSquared += pow(WTA_Array[i] - WTA_AVG, 2);
+    fprintf(perfLogFile, "Avg WTA = %.2f\n", runningStatsMean(&job_stats.wta));
+    fprintf(perfLogFile, "Avg Waiting = %.2f\n", runningStatsMean(&job_stats.waiting));
+    fprintf(perfLogFile, "Std WTA = %.2f\n", runningStatsStd(&job_stats.wta));
+    fprintf(perfLogFile, "Std Waiting = %.2f\n", runningStatsStd(&job_stats.waiting));
+    fprintf(perfLogFile, "Avg TA = %.2f\n", runningStatsMean(&job_stats.ta));
+    fprintf(perfLogFile, "Std TA = %.2f\n", runningStatsStd(&job_stats.ta));
+    const char *names[] = {"WTA", "Waiting", "TA"};
+    const QuantileSketch *sketches[] = {&job_stats.wta_quantiles, &job_stats.waiting_quantiles, &job_stats.ta_quantiles};
+    for (int i = 0; i < 3; i++)
+    {
+        fprintf(perfLogFile, "%s p50 = %.2f p95 = %.2f p99 = %.2f\n", names[i],
+                quantileSketchQuantile(sketches[i], 0.50),
+                quantileSketchQuantile(sketches[i], 0.95),
+                quantileSketchQuantile(sketches[i], 0.99));
+    }
+    if (cpu_count > 1)
+    {
+        for (int i = 0; i < cpu_count; i++)
+        {
+            double busy = current_time > 0 ? round(cpus[i].busy_ticks * 10000.0 / current_time) / 100 : 0;
+            fprintf(perfLogFile, "CPU %d utilization = %.2f %% dispatches = %d steals = %d balanced in = %d\n",
+                    i, busy, cpus[i].dispatches, cpus[i].steals, cpus[i].balanced_in);
+        }
     }
-    fprintf(perfLogFile, "Std WTA = %.2f\n", pow(diffSquared / static_process_count, 1.0 / 2));
 }
 
-
-void PCB_add(PCB *process)
+void log_latency_stats()
 {
-    if (!process)
+    if (!phase_latency)
         return;
-
-    if (PCB_table_head == NULL)
+    FILE *latencyFile = fopen(LATENCY_FILE, "w");
+    if (!latencyFile)
     {
-        PCB_table_head = process;
-        PCB_table_tail = process;
-        process->next = NULL;
+        perror("Failed to open latency file");
+        return;
     }
+    fprintf(latencyFile, "#Scheduler time per tick phase in ns over %llu ticks\n",
+            (unsigned long long)phase_latency[PHASE_TICK].count);
+    fprintf(latencyFile, "#%-11s %10s %10s %10s %10s %10s %10s %10s %12s\n",
+            "phase", "count", "min", "p50", "p90", "p99", "p99.9", "max", "mean");
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        const LatencyHistogram *h = &phase_latency[i];
+        fprintf(latencyFile, "%-12s %10llu %10llu %10llu %10llu %10llu %10llu %10llu %12.1f\n",
+                phase_names[i], (unsigned long long)h->count, (unsigned long long)h->min,
+                (unsigned long long)latencyHistogramPercentile(h, 50),
+                (unsigned long long)latencyHistogramPercentile(h, 90),
+                (unsigned long long)latencyHistogramPercentile(h, 99),
+                (unsigned long long)latencyHistogramPercentile(h, 99.9),
+                (unsigned long long)h->max, latencyHistogramMean(h));
+    }
+    if (is_fast_forward())
+        fprintf(latencyFile, "Ticks missed = n/a (fast-forward skips idle ticks on purpose)\n");
     else
+        fprintf(latencyFile, "Ticks missed = %ld in %d skips, largest %d\n", ticks_missed, tick_skips, largest_skip);
+    fclose(latencyFile);
+}
+
+// O(1) per job: nothing is kept per process id
+void record_job_stats(int TA, int wait, int runtime)
+{
+    if (runtime > 0)
     {
-        PCB_table_tail->next = process;
-        PCB_table_tail = process;
-        process->next = NULL;
+        double WTA = (double)TA / runtime;
+        runningStatsAdd(&job_stats.wta, WTA);
+        quantileSketchAdd(&job_stats.wta_quantiles, WTA);
     }
+    runningStatsAdd(&job_stats.waiting, wait);
+    quantileSketchAdd(&job_stats.waiting_quantiles, wait);
+    runningStatsAdd(&job_stats.ta, TA);
+    quantileSketchAdd(&job_stats.ta_quantiles, TA);
+}
 
-    process_count++;
+static void write_stats_fields(FILE *out, const char *name, const RunningStats *stats, const QuantileSketch *sketch)
+{
+    fprintf(out, " %s avg %.2f std %.2f p50 %.2f p95 %.2f p99 %.2f", name,
+            runningStatsMean(stats), runningStatsStd(stats),
+            quantileSketchQuantile(sketch, 0.50),
+            quantileSketchQuantile(sketch, 0.95),
+            quantileSketchQuantile(sketch, 0.99));
 }
 
-void PCB_remove(PCB *process)
+void snapshot_job_stats()
 {
-    if (!PCB_table_head || !process)
+    if (!statsFile)
         return;
-    waiting += process->wait_time;
+    fprintf(statsFile, "At time %d finished %ld", current_time, job_stats.ta.count);
+    write_stats_fields(statsFile, "WTA", &job_stats.wta, &job_stats.wta_quantiles);
+    write_stats_fields(statsFile, "Waiting", &job_stats.waiting, &job_stats.waiting_quantiles);
+    write_stats_fields(statsFile, "TA", &job_stats.ta, &job_stats.ta_quantiles);
+    fprintf(statsFile, "\n");
+    fflush(statsFile);
+}
+// Seqlocked, so kernix-top never sees a half-written tick
+void publish_stats()
+{
+    if (!channels.stats)
+        return;
+    stats_scheduler_section_t *section = &channels.stats->scheduler;
+    stats_page_begin(&section->seq);
+    section->time = current_time;
+    section->tick_lag = tick_lag;
+    section->cpu_count = cpu_count;
+    section->ready = section->running = 0;
+    section->context_switches = section->preemptions = 0;
+    for (int i = 0; i < cpu_count; i++)
+    {
+        section->cpu_ready[i] = policy->size(cpus[i].ready);
+        section->cpu_job[i] = cpus[i].running ? cpus[i].running->id : -1;
+        section->ready += section->cpu_ready[i];
+        section->running += cpus[i].running != NULL;
+        section->context_switches += cpus[i].dispatches;
+        section->preemptions += cpus[i].preemptions;
+    }
+    section->ticks_missed = ticks_missed;
+    section->live = process_count;
+    section->finished = job_stats.ta.count;
+    section->avg_wta = runningStatsMean(&job_stats.wta);
+    section->avg_waiting = runningStatsMean(&job_stats.waiting);
+    section->avg_ta = runningStatsMean(&job_stats.ta);
+    stats_page_end(&section->seq);
+}
 
-    // Clean up shared memory resources BEFORE freeing the PCB
-    if (process->shm_ptr != (int *)-1 && process->shm_ptr != NULL)
+PCB *PCB_alloc()
+{
+    int index;
+    PCB *process = (PCB *)slabAllocIndexed(PCB_slab, &index);
+    if (process)
     {
-        shmdt(process->shm_ptr); // Detach from shared memory
+        process->slab_index = index;
     }
+    return process;
+}
 
-    if (process->shm_id > 0)
-    {
-        shmctl(process->shm_id, IPC_RMID, NULL); // Mark shared memory for removal
-    }
+PCB *PCB_at(int slab_index)
+{
+    return slab_index < 0 ? NULL : (PCB *)slabAt(PCB_slab, slab_index);
+}
 
-    // Continue with existing PCB removal logic
-    if (PCB_table_head == process)
-    {
-        PCB_table_head = process->next;
+void PCB_add(PCB *process)
+{
+    if (!process)
+        return;
 
-        if (PCB_table_tail == process)
-        {
-            PCB_table_tail = NULL;
-        }
-    }
-    else
-    {
-        PCB *current = PCB_table_head;
-        while (current && current->next != process)
-        {
-            current = current->next;
-        }
+    hashMapPut(PCB_by_pid, process->pid, process);
+    hashMapPut(PCB_by_id, process->id, process);
 
-        if (current)
-        {
-            current->next = process->next;
+    process_count++;
+}
 
-            if (PCB_table_tail == process)
-            {
-                PCB_table_tail = current;
-            }
-        }
-        else
-        {
-            return;
-        }
+PCB *PCB_find_by_pid(pid_t pid)
+{
+    return (PCB *)hashMapGet(PCB_by_pid, pid);
+}
+
+PCB *PCB_find_by_id(int id)
+{
+    return (PCB *)hashMapGet(PCB_by_id, id);
+}
+
+void PCB_remove(PCB *process)
+{
+    if (!process || hashMapRemove(PCB_by_pid, process->pid) != process)
+        return;
+    // Only drop the id entry if it still points at this PCB (ids may repeat)
+    if (PCB_find_by_id(process->id) == process)
+    {
+        hashMapRemove(PCB_by_id, process->id);
     }
 
-    free(process);
+    slabFreeIndexed(PCB_slab, process, process->slab_index);
     process_count--;
 }
 
@@ -646,51 +900,44 @@ void cleanup() {
     printf("\033[0;34m"); printf("[Scheduler] "); printf("\033[0m");
     printf("Cleaning up scheduler resources...\n");
 
-    if (logFile)
+    event_log_close(logFile);
+    logFile = NULL;
+    if (statsFile)
     {
-        fclose(logFile);
+        fclose(statsFile);
+        statsFile = NULL;
     }
 
-    // Clean up running process if it exists
-    if (running_process)
+    // Clean up running processes if any
+    for (int i = 0; cpus && i < cpu_count; i++)
     {
-        PCB_remove(running_process);
-        running_process = NULL;
-    }
-
-    // Clean up all remaining PCBs
-    PCB *current = PCB_table_head;
-    while (current)
-    {
-        PCB *next = current->next;
-
-        // Double-check shared memory cleanup
-        if (current->shm_ptr != (int *)-1 && current->shm_ptr != NULL)
+        if (cpus[i].running)
         {
-            shmdt(current->shm_ptr);
+            PCB_remove(cpus[i].running);
+            cpus[i].running = NULL;
         }
-        if (current->shm_id > 0)
-        {
-            shmctl(current->shm_id, IPC_RMID, NULL);
-        }
-
-        free(current);
-        current = next;
     }
 
-    // Free ready queue
-    switch (algorithm)
+    // Clean up all remaining PCBs
+    destroyHashMap(PCB_by_pid);
+    destroyHashMap(PCB_by_id);
+    destroySlab(PCB_slab);
+    PCB_by_pid = PCB_by_id = NULL;
+    PCB_slab = NULL;
+
+    // Free ready queues
+    for (int i = 0; cpus && i < cpu_count; i++)
     {
-    case HPF:
-    case SRTN:
-        if (readyQueue)
-            destroyHeap(readyQueue);
-        break;
-    case RR:
-        if (readyQueue)
-            free(readyQueue);
-        break;
+        if (cpus[i].ready)
+            policy->destroy(cpus[i].ready);
     }
+    free(cpus);
+    cpus = NULL;
+
+    destroyShmRing(channels.arrivals);
+    destroyShmRing(channels.exits);
+    destroyShmRing(channels.finished);
+    stats_page_destroy(channels.stats, 0);
 
     destroy_clk(0);
     exit(0);
@@ -698,15 +945,5 @@ void cleanup() {
 
 
 int Empty(void * RQ){
-
-    if (algorithm == RR)
-    {
-        Queue *q = (Queue *)RQ;
-        return q->size == 0;
-    }
-    else
-    {
-        MinHeap *mh = (MinHeap *)RQ;
-        return mh->size == 0;
-    }
-}
\ No newline at end of file
+    return policy->size(RQ) == 0;
+}
@@ -3,26 +3,35 @@
 
 // Include necessary headers
 #include "clk.h"
+#include "process.h"
+#include "eventlog.h"
+#include "statspage.h"
 #include <stdio.h>
-#include "models/Queue/queue.h"
-#include "models/minHeap1/minHeap.h"
+#include "policies/policy.h"
+#include "models/HashMap/hashMap.h"
+#include "models/Slab/slab.h"
+#include "models/ShmRing/shmRing.h"
+#include "models/Stats/stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <signal.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
-#include <sys/msg.h>
 #include <sys/shm.h>
 #include <sys/wait.h>
 #include <string.h>
 
-// Constants for scheduling algorithms
-#define HPF 1  // Highest Priority First
-#define SRTN 2 // Shortest Remaining Time Next
-#define RR 3   // Round Robin
+// Execution backends for simulated processes
+#define BACKEND_FORK 0   // One forked `process` per job, driven by SIGSTOP/SIGCONT
+#define BACKEND_INPROC 1 // Jobs are plain PCB records inside the scheduler
 
-#define MAX_PROCESSES 100
+#define PCB_CHUNK 128 // PCBs per slab chunk
+
+#define MAX_CPUS 64          // Largest -c
+#define STATS_SNAPSHOT_FILE "scheduler.stats" // Written every -S ticks
+#define LATENCY_FILE "scheduler.latency"      // Written with -T
+#define BALANCE_INTERVAL 10  // Ticks between load-balancing passes
 
 // Process states
 #define READY 0    // Process is ready to run
@@ -41,55 +50,103 @@ struct PCB {
     int wait_time;         // Time spent waiting
     int start_time;        // Time when the process started
     int status;            // Current status of the process
-    struct PCB* next;      // Pointer to the next PCB in the list
-    int shm_id;            // Shared memory ID
-    int *shm_ptr;          // Pointer to shared memory
+    ProcessSlot* slot;     // Control slot shared with the forked process, NULL in-process
     int ending_time;       // Time when the process finished
+    int slab_index;        // Dense index in the PCB slab, names the PCB in the ready heap
+    int level;             // MLFQ priority level, 0 is the highest
+    long long vruntime;    // CFS weighted virtual runtime
+    int cpu;               // CPU whose ready queue holds it or that runs it
 };
 
 typedef struct PCB PCB; // Typedef for easier usage of PCB
 
+// One simulated CPU: the job on it and its own ready queue
+typedef struct {
+    int id;
+    PCB* running;          // NULL when idle
+    void* ready;           // This CPU's policy state
+    int busy_ticks;        // Ticks spent running jobs
+    int dispatches;        // Starts and resumes here
+    int steals;            // Jobs pulled from another CPU while idle
+    int balanced_in;       // Jobs moved here by the balancing pass
+    int preemptions;       // Running jobs stopped here before finishing
+} CPU;
+
+// Turnaround figures of the finished jobs, kept online. Constant size and
+// pointer-free, so a snapshot is a struct copy.
+typedef struct {
+    RunningStats wta;      // Jobs with a runtime only, WTA is undefined otherwise
+    RunningStats waiting;
+    RunningStats ta;
+    QuantileSketch wta_quantiles;
+    QuantileSketch waiting_quantiles;
+    QuantileSketch ta_quantiles;
+} JobStats;
 
-// Message structure for process communication
+// One admitted process, as handed from the generator to the scheduler
 typedef struct {
-    long mtype;            // Message type
     int process_id;        // Process ID
     int arrival_time;      // Time of arrival
     int runtime;           // Total runtime
     int priority;          // Priority of the process
     pid_t pid;             // Process ID in the system
-    int shm_id;            // Shared memory ID
-} ProcessMessage;
+    int slot;              // Index in the shared slot array
+} ArrivalRecord;
+
+#define ARRIVALS_DONE -2 // process_id of the record after the last arrival
+
+// A finished process, reported to the other side
+typedef struct {
+    pid_t pid;             // pid of the completed process
+    int finish_time;       // Scheduler tick it finished at, 0 on the exits ring
+} CompletionRecord;
 
-// Message structure for completion notifications
+// Shared memory between the generator and the scheduler. The generator
+// creates it before forking the scheduler, which inherits the mappings.
+// Each ring has one producer and one consumer, and is sized for every job
+// so a push never has to wait.
 typedef struct {
-    long mtype;            // Message type (use 1 for completion messages)
-    int process_id;        // ID of the completed process
-    int finish_time;       // Time when the process finished
-} CompletionMessage;
+    ShmRing* arrivals;     // generator -> scheduler: ArrivalRecord, one publish per tick
+    ShmRing* exits;        // generator -> scheduler: CompletionRecord of a reaped child
+    ShmRing* finished;     // scheduler -> generator: CompletionRecord of every finished job, in CPU order
+    ProcessSlot* slots;    // One per job, NULL with the inproc backend
+    stats_page_t* stats;   // Live metrics page, NULL if it could not be created
+} SchedulerChannels;
 
 // Function prototypes for scheduler operations
-void initialize(int alg, int q); // Initialize the scheduler with algorithm and quantum
+void initialize(const scheduler_policy_t* pol, const policy_options_t* options, int be, int cpus, int expected_jobs, const SchedulerChannels* ch); // Initialize the scheduler with a policy and its options, backend, CPU count, a table size hint and the rings to the generator
 void run_scheduler();           // Main function to run the scheduler
 void cleanup();                 // Cleanup resources after scheduling
 
 // Function prototypes for process management
-PCB* select_next_process();     // Select the next process to run
-void update_process_times();    // Update process times (e.g., remaining time)
-void handle_finished_process(); // Handle processes that have finished execution
+PCB* select_next_process(CPU* cpu); // Select the next process to run on a CPU
+void update_process_times(int elapsed); // Update the times of every running process
+void wait_for_exits();          // With the fork backend, wait for the generator to reap this tick's finished processes
+void handle_finished_process(); // Handle processes that have finished execution on any CPU
 void check_arrivals();          // Check for newly arrived processes
 void start_process(PCB* process); // Start a process
 void stop_process(PCB* process);  // Stop a running process
-void log_process_state(PCB* process, char* state); // Log the state of a process
+void publish_slot(PCB* process);  // Share remaining time and state with the process, waking it to exit
+void log_process_state(PCB* process, int event); // Log an EVENT_* state change of a process
 void log_performance_stats();   // Log overall performance statistics
+void record_job_stats(int TA, int wait, int runtime); // Account one finished job
+void set_stats_interval(int ticks); // Snapshot the job stats every `ticks` ticks, 0 for never; call before forking the scheduler
+void snapshot_job_stats();      // Append the job stats so far to STATS_SNAPSHOT_FILE
+void publish_stats();           // Refresh the scheduler's section of the live metrics page
+void set_latency_tracing(int enabled); // Time every phase of every tick; call before forking the scheduler
+void log_latency_stats();       // Write the phase latency histograms and missed ticks to LATENCY_FILE
 
 // Utility functions for process comparison and management
-int compare_priority(void* a, void* b);       // Compare processes by priority
-int compare_remaining_time(void* a, void* b); // Compare processes by remaining time
-void PCB_remove(PCB* process);               // Remove a process from the list
-void PCB_add(PCB* process);                  // Add a process to the list
-int Empty(void* RQ);                        // Check if the ready queue is empty
-void check_context_switch();
+PCB* PCB_at(int slab_index);                   // PCB with a slab index, NULL for -1
+PCB* PCB_alloc();                            // Get a PCB from the slab
+void PCB_remove(PCB* process);               // Remove a process from the table and free it
+void PCB_add(PCB* process);                  // Index a process by pid and by id
+PCB* PCB_find_by_pid(pid_t pid);             // O(1) lookup by system pid
+PCB* PCB_find_by_id(int id);                 // O(1) lookup by process id
+int Empty(void* RQ);                        // Check if the policy's ready set is empty
+void check_context_switch();    // Dispatch on every CPU, stealing work for idle ones
+void balance_load();            // Even out ready queue lengths across CPUs
+int next_scheduler_event();      // Next tick the scheduler needs in fast-forward mode
 
 
-#endif /* SCHEDULER_H */
\ No newline at end of file
+#endif /* SCHEDULER_H */
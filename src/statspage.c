@@ -0,0 +1,103 @@
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include "statspage.h"
+
+#define STATS_PAGE_READ_TRIES 1000
+
+stats_page_t *stats_page_create()
+{
+    int shmid = shmget(STATS_PAGE_KEY, sizeof(stats_page_t), IPC_CREAT | 0644);
+    if (shmid == -1)
+    {
+        // A smaller page left by an older build: replace it
+        shmctl(shmget(STATS_PAGE_KEY, 0, 0644), IPC_RMID, NULL);
+        shmid = shmget(STATS_PAGE_KEY, sizeof(stats_page_t), IPC_CREAT | 0644);
+    }
+    if (shmid == -1)
+    {
+        perror("Error creating stats page");
+        return NULL;
+    }
+    stats_page_t *page = shmat(shmid, NULL, 0);
+    if (page == (void *)-1)
+    {
+        perror("Error attaching stats page");
+        return NULL;
+    }
+
+    memset(page, 0, sizeof(*page));
+    page->version = STATS_PAGE_VERSION;
+    page->size = sizeof(stats_page_t);
+    page->generator_pid = getpid();
+    page->active = 1;
+    // Readers check the magic first, so it goes in last
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(page->magic, STATS_PAGE_MAGIC, sizeof(page->magic));
+    return page;
+}
+
+const stats_page_t *stats_page_attach()
+{
+    int shmid = shmget(STATS_PAGE_KEY, 0, 0);
+    if (shmid == -1)
+        return NULL;
+    const stats_page_t *page = shmat(shmid, NULL, SHM_RDONLY);
+    if (page == (void *)-1)
+        return NULL;
+    if (memcmp(page->magic, STATS_PAGE_MAGIC, sizeof(page->magic)) != 0 ||
+        page->version != STATS_PAGE_VERSION || page->size != sizeof(stats_page_t))
+    {
+        shmdt(page);
+        return NULL;
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return page;
+}
+
+void stats_page_begin(volatile uint32_t *seq)
+{
+    __atomic_store_n(seq, *seq + 1, __ATOMIC_RELAXED);
+    // The odd count must be visible before any of the new values
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void stats_page_end(volatile uint32_t *seq)
+{
+    __atomic_store_n(seq, *seq + 1, __ATOMIC_RELEASE);
+}
+
+int stats_page_read(const void *section, void *copy, size_t size)
+{
+    const volatile uint32_t *seq = section;
+    for (int attempt = 0; attempt < STATS_PAGE_READ_TRIES; attempt++)
+    {
+        uint32_t before = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        if (before & 1)
+        {
+            sched_yield();
+            continue;
+        }
+        memcpy(copy, section, size);
+        // The copy must be complete before the count is checked again
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(seq, __ATOMIC_RELAXED) == before)
+            return 0;
+    }
+    return -1;
+}
+
+void stats_page_destroy(stats_page_t *page, int remove)
+{
+    if (page == NULL)
+        return;
+    if (remove)
+    {
+        __atomic_store_n(&page->active, 0, __ATOMIC_RELEASE);
+        shmctl(shmget(STATS_PAGE_KEY, 0, 0), IPC_RMID, NULL); // Gone once readers detach
+    }
+    shmdt(page);
+}
@@ -0,0 +1,95 @@
+#ifndef STATSPAGE_H
+#define STATSPAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Live metrics page.
+ * A small shared memory segment under a fixed key that the scheduler and the
+ * generator refresh once per tick and kernix-top reads while a run goes on.
+ * Each writer owns one section behind its own sequence lock: the count is
+ * odd while an update is in progress, and a reader retries any copy that
+ * overlapped one. Readers attach read-only, so watching a run never blocks
+ * or changes it.
+ */
+
+#define STATS_PAGE_KEY 301 // Next to the clock's key
+#define STATS_PAGE_MAGIC "KXSTATS1"
+#define STATS_PAGE_VERSION 1
+#define STATS_PAGE_MAX_CPUS 64
+#define STATS_PAGE_MAX_ORDERS 64
+#define STATS_PAGE_CACHE_LINE 64
+
+// Written by the scheduler after its dispatch stage
+typedef struct
+{
+    volatile uint32_t seq;
+    int32_t time;              // Tick these numbers belong to
+    int32_t tick_lag;          // Clock ticks already past `time` when published
+    int32_t cpu_count;
+    int32_t ready;             // Jobs in the ready queues of all CPUs
+    int32_t running;           // CPUs running a job
+    int32_t live;              // Admitted jobs that did not finish yet
+    int32_t ticks_missed;      // Real-time ticks that passed before the scheduler saw them
+    int64_t finished;
+    int64_t context_switches;  // Starts and resumes
+    int64_t preemptions;       // Running jobs stopped before finishing
+    double avg_wta, avg_waiting, avg_ta;
+    int32_t cpu_ready[STATS_PAGE_MAX_CPUS];
+    int32_t cpu_job[STATS_PAGE_MAX_CPUS]; // Running process id, -1 when idle
+} __attribute__((aligned(STATS_PAGE_CACHE_LINE))) stats_scheduler_section_t;
+
+// Written by the generator after its arrivals stage
+typedef struct
+{
+    volatile uint32_t seq;
+    int32_t time;
+    int32_t tick_lag;
+    int32_t jobs;              // Jobs in the input
+    int32_t arrived;           // Jobs whose arrival time has come
+    int32_t waiting;           // Arrived jobs still blocked on memory
+    int32_t min_order;         // Smallest and largest buddy block, log2 bytes
+    int32_t max_order;
+    int64_t free_bytes;
+    int64_t free_blocks[STATS_PAGE_MAX_ORDERS]; // Indexed by order
+} __attribute__((aligned(STATS_PAGE_CACHE_LINE))) stats_generator_section_t;
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t size;             // sizeof(stats_page_t) of the writer
+    int32_t generator_pid;
+    volatile int32_t active;   // 0 once the run is over
+    stats_scheduler_section_t scheduler;
+    stats_generator_section_t generator;
+} stats_page_t;
+
+/*
+ * Create (or take over a stale) page for a new run and mark it active.
+ * The generator calls it before forking the scheduler, which inherits the
+ * mapping. Returns NULL on failure.
+ */
+stats_page_t *stats_page_create();
+/*
+ * Attach an existing page read-only. Returns NULL if there is none or it
+ * was written by an incompatible build.
+ */
+const stats_page_t *stats_page_attach();
+/*
+ * Writer side: bracket every update of a section.
+ */
+void stats_page_begin(volatile uint32_t *seq);
+void stats_page_end(volatile uint32_t *seq);
+/*
+ * Reader side: copy a consistent `size`-byte section that starts with its
+ * sequence count. Returns 0, or -1 if the writer stayed mid-update.
+ */
+int stats_page_read(const void *section, void *copy, size_t size);
+/*
+ * Detach, and with `remove` also mark the run over and delete the page.
+ */
+void stats_page_destroy(stats_page_t *page, int remove);
+
+#endif